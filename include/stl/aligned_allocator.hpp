@@ -0,0 +1,47 @@
+#ifndef STL_ALIGNED_ALLOCATOR_HPP_
+#define STL_ALIGNED_ALLOCATOR_HPP_
+
+#include <stl/allocator.hpp>
+#include <stl/algorithm.hpp>
+
+namespace stl {
+
+// Allocator adaptor that aligns every allocation from Parent to at least Alignment bytes.
+// For example, stl::vector<float, stl::aligned_allocator<stl::cache_line_size>> stores its elements
+// in a cache line aligned buffer.
+template<stl::size_t Alignment, typename Parent = stl::allocator>
+class aligned_allocator : public allocator_base {
+public:
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+
+    static constexpr stl::size_t alignment = Alignment;
+
+    virtual ~aligned_allocator() = default;
+
+    void* allocate(stl::size_t size) override {
+        return _parent.allocate_aligned(size, Alignment);
+    }
+
+    void deallocate(void* ptr, stl::size_t size) override {
+        _parent.deallocate_aligned(ptr, size, Alignment);
+    }
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) override {
+        return _parent.allocate_aligned(size, stl::max(alignment, Alignment));
+    }
+
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) override {
+        _parent.deallocate_aligned(ptr, size, stl::max(alignment, Alignment));
+    }
+
+    stl::size_t good_size(stl::size_t size) const override {
+        return _parent.good_size(size);
+    }
+
+private:
+    Parent _parent;
+};
+
+}
+
+#endif
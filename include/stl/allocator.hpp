@@ -5,6 +5,12 @@
 
 namespace stl {
 
+// Alignment of memory returned by allocate()
+constexpr stl::size_t default_alignment = alignof(std::max_align_t);
+// Common alignments for large buffers, to be passed to allocate_aligned()
+constexpr stl::size_t cache_line_size = 64;
+constexpr stl::size_t page_size = 4096;
+
 // Interface for allocator classes. Useful for polymorphic allocators
 class allocator_base {
 public:
@@ -12,17 +18,168 @@ public:
 
     virtual void* allocate(stl::size_t size) = 0;
     virtual void deallocate(void* ptr, stl::size_t size) = 0;
+
+    // Allocates memory aligned to alignment, which must be a power of two. The default implementation
+    // forwards to allocate() for alignments up to default_alignment and over-allocates otherwise.
+    virtual void* allocate_aligned(stl::size_t size, stl::size_t alignment);
+    // Frees memory obtained from allocate_aligned(). size and alignment must match the allocation
+    virtual void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment);
+
+    // Tries to resize the allocation at ptr to new_size bytes without moving it. Returns false if the
+    // allocation was left untouched. The default implementation always fails.
+    virtual bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size);
+    // Resizes an allocation made with allocate(), possibly moving it to a new address. Contents are moved
+    // bytewise, so this may only be used for trivially relocatable data. The default implementation
+    // tries try_expand() first and falls back to allocate, copy and deallocate.
+    virtual void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size);
+
+    // Returns the amount of bytes that would actually be reserved for a request of size bytes, so containers
+    // can grow into memory they get anyway. The default implementation returns size.
+    virtual stl::size_t good_size(stl::size_t size) const;
 };
 
+// Allocates from malloc and free instead of operator new, so reallocate() can use realloc. Replacements of the
+// global operator new and hooks on it do not see these allocations. Only allocations aligned past
+// default_alignment still use the aligned operator new.
 class allocator : public allocator_base {
 public:
     virtual ~allocator() = default;
 
     void* allocate(stl::size_t size) override;
     void deallocate(void* ptr, stl::size_t size) override;
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) override;
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) override;
+
+    void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) override;
+};
+
+// Returns a process-wide stl::allocator instance. Used as the default parent for allocators that
+// need somewhere to get their memory from.
+allocator_base& default_allocator();
+
+// Non-owning handle to an allocator_base, so many containers can share one allocator (for example a
+// per-frame arena) while storing only a pointer. A default constructed handle refers to default_allocator().
+// The referenced allocator must outlive every container using it.
+class allocator_ref {
+public:
+    allocator_ref();
+    allocator_ref(allocator_base& allocator);
+
+    allocator_ref(allocator_ref const&) = default;
+    allocator_ref& operator=(allocator_ref const&) = default;
+
+    void* allocate(stl::size_t size);
+    void deallocate(void* ptr, stl::size_t size);
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment);
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment);
+
+    bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size);
+    void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size);
+
+    stl::size_t good_size(stl::size_t size) const;
+
+    allocator_base& get() const;
+
+    bool operator==(allocator_ref rhs) const;
+    bool operator!=(allocator_ref rhs) const;
+
+private:
+    allocator_base* _allocator;
+};
+
+// Describes what happens to a container's allocator when the container is copied, moved or swapped.
+// Specialize this for allocators that need other rules.
+template<typename Allocator>
+struct allocator_traits {
+    // Whether copy assignment replaces the allocator with the one of the source container
+    static constexpr bool propagate_on_copy_assignment = false;
+    // Whether move assignment takes over the allocator of the source container. If not, the buffer
+    // is only taken over when both allocators are equal, otherwise the elements are moved one by one.
+    static constexpr bool propagate_on_move_assignment = true;
+    // Whether swapping two containers also swaps their allocators. If not, both allocators must be equal
+    static constexpr bool propagate_on_swap = true;
+    // Whether memory stays valid when the allocator that made it is moved to another object. If not,
+    // moving or swapping containers moves their elements one by one.
+    static constexpr bool buffer_survives_move = true;
+
+    // Returns the allocator for a container copy constructed from a container using allocator
+    static Allocator select_on_copy_construction(Allocator const& allocator) {
+        return allocator;
+    }
+
+    // Whether memory allocated by one allocator can be freed by the other
+    static bool equal(Allocator const&, Allocator const&) {
+        return true;
+    }
+};
+
+// Copies share the allocator, but a container never adopts memory from an allocator it was not created
+// with, since that allocator may be shorter lived (e.g. a per-frame arena).
+template<>
+struct allocator_traits<allocator_ref> {
+    static constexpr bool propagate_on_copy_assignment = false;
+    static constexpr bool propagate_on_move_assignment = false;
+    static constexpr bool propagate_on_swap = true;
+    static constexpr bool buffer_survives_move = true;
+
+    static allocator_ref select_on_copy_construction(allocator_ref allocator) {
+        return allocator;
+    }
+
+    static bool equal(allocator_ref lhs, allocator_ref rhs) {
+        return lhs == rhs;
+    }
 };
 
+inline allocator_ref::allocator_ref() : _allocator(&default_allocator()) {
+
+}
+
+inline allocator_ref::allocator_ref(allocator_base& allocator) : _allocator(&allocator) {
 
+}
+
+inline void* allocator_ref::allocate(stl::size_t size) {
+    return _allocator->allocate(size);
+}
+
+inline void allocator_ref::deallocate(void* ptr, stl::size_t size) {
+    _allocator->deallocate(ptr, size);
+}
+
+inline void* allocator_ref::allocate_aligned(stl::size_t size, stl::size_t alignment) {
+    return _allocator->allocate_aligned(size, alignment);
+}
+
+inline void allocator_ref::deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) {
+    _allocator->deallocate_aligned(ptr, size, alignment);
+}
+
+inline bool allocator_ref::try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+    return _allocator->try_expand(ptr, old_size, new_size);
+}
+
+inline void* allocator_ref::reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+    return _allocator->reallocate(ptr, old_size, new_size);
+}
+
+inline stl::size_t allocator_ref::good_size(stl::size_t size) const {
+    return _allocator->good_size(size);
+}
+
+inline allocator_base& allocator_ref::get() const {
+    return *_allocator;
+}
+
+inline bool allocator_ref::operator==(allocator_ref rhs) const {
+    return _allocator == rhs._allocator;
+}
+
+inline bool allocator_ref::operator!=(allocator_ref rhs) const {
+    return _allocator != rhs._allocator;
+}
 
 }
 
@@ -0,0 +1,87 @@
+#ifndef STL_ARENA_ALLOCATOR_HPP_
+#define STL_ARENA_ALLOCATOR_HPP_
+
+#include <stl/allocator.hpp>
+
+namespace stl {
+
+// Bump pointer allocator that serves allocations from a chain of large blocks. deallocate() is a no-op,
+// memory is only reclaimed by reset(), rewind() or when the arena is destroyed.
+class arena_allocator : public allocator_base {
+public:
+    static constexpr stl::size_t default_block_size = 64 * 1024;
+
+    // Position in the arena that can be passed to rewind()
+    struct marker {
+        void* block = nullptr;
+        stl::size_t offset = 0;
+    };
+
+    arena_allocator();
+    // Blocks are allocated from parent, or from stl::default_allocator() if parent is null
+    explicit arena_allocator(stl::size_t block_size, allocator_base* parent = nullptr);
+
+    arena_allocator(arena_allocator const&) = delete;
+    arena_allocator(arena_allocator&& rhs);
+
+    arena_allocator& operator=(arena_allocator const&) = delete;
+    arena_allocator& operator=(arena_allocator&& rhs);
+
+    ~arena_allocator();
+
+    void* allocate(stl::size_t size) override;
+    void deallocate(void* ptr, stl::size_t size) override;
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) override;
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) override;
+
+    // Succeeds if ptr is the most recent allocation and the current block has room for new_size bytes
+    bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) override;
+
+    // Returns the current position in the arena
+    marker get_marker() const;
+    // Frees everything allocated after m was obtained. Blocks are kept around for reuse
+    void rewind(marker m);
+    // Frees all allocations. Blocks are kept around for reuse
+    void reset();
+    // Frees all allocations and gives the blocks back to the parent allocator
+    void release();
+
+    stl::size_t block_size() const;
+    allocator_base* parent() const;
+
+private:
+    struct block;
+
+    block* _first = nullptr;
+    block* _current = nullptr;
+    // Offset into the data of the current block
+    stl::size_t _offset = 0;
+    stl::size_t _block_size = default_block_size;
+    allocator_base* _parent = nullptr;
+
+    // Makes _current point to a block with at least size bytes of free space
+    void next_block(stl::size_t size);
+};
+
+// An arena owns its memory, so a copied container gets a fresh arena and copy assignment keeps the
+// destination's arena. Moving a container moves the arena along with it.
+template<>
+struct allocator_traits<arena_allocator> {
+    static constexpr bool propagate_on_copy_assignment = false;
+    static constexpr bool propagate_on_move_assignment = true;
+    static constexpr bool propagate_on_swap = true;
+    static constexpr bool buffer_survives_move = true;
+
+    static arena_allocator select_on_copy_construction(arena_allocator const& allocator) {
+        return arena_allocator(allocator.block_size(), allocator.parent());
+    }
+
+    static bool equal(arena_allocator const& lhs, arena_allocator const& rhs) {
+        return &lhs == &rhs;
+    }
+};
+
+}
+
+#endif
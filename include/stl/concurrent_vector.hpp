@@ -0,0 +1,341 @@
+#ifndef STL_CONCURRENT_VECTOR_HPP_
+#define STL_CONCURRENT_VECTOR_HPP_
+
+#include <stl/allocator.hpp>
+#include <stl/memory.hpp>
+#include <stl/utility.hpp>
+#include <stl/assert.hpp>
+
+#include <atomic>
+#include <type_traits>
+
+namespace stl {
+
+namespace detail {
+
+// Index of the highest set bit. value must not be zero
+inline stl::size_t highest_bit(stl::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    stl::size_t bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+}
+
+// Append-only vector that any number of threads can push to at the same time without a lock.
+// A push claims a slot with a compare-and-swap on a counter and constructs the value in place. Storage is a
+// list of segments, each twice as large as the one before, so elements never move once constructed.
+// size() is the length of the prefix in which every element is fully constructed, and that prefix can be
+// read and iterated by any thread while others keep pushing. Every slot has a ready flag, and a push only
+// sets the flag of its own slot. The prefix is advanced lazily by size(), over the ready flags, so the claim
+// counter is the only shared state a push writes to, and a push never waits on a slower thread that claimed
+// an earlier slot.
+// A claimed slot must always become ready, otherwise the prefix could never move past it. A slot is only
+// claimed once its segment is allocated, and elements whose constructor may throw are constructed before
+// claiming and moved into the slot, which needs a nothrow move constructor. Nothing after a claim can fail.
+// Allocator must be safe to use from multiple threads.
+template<typename T, typename Allocator = stl::allocator>
+class concurrent_vector {
+public:
+    using value_type = T;
+
+    // Elements in the first segment. Segment k holds first_segment_size << k elements
+    static constexpr stl::size_t first_segment_size = 32;
+
+    // Iterates over the prefix that was published when begin() or end() was called
+    template<typename U>
+    class basic_iterator {
+    public:
+        using value_type = T;
+
+        basic_iterator(concurrent_vector const* vec, stl::size_t index) : _vec(vec), _index(index) {}
+
+        U& operator*() const { return *_vec->slot(_index); }
+        U* operator->() const { return &**this; }
+
+        basic_iterator& operator++() { ++_index; return *this; }
+        basic_iterator operator++(int) { basic_iterator old = *this; ++_index; return old; }
+
+        bool operator==(basic_iterator rhs) const { return _index == rhs._index; }
+        bool operator!=(basic_iterator rhs) const { return _index != rhs._index; }
+
+        stl::size_t get_index() const { return _index; }
+
+    private:
+        concurrent_vector const* _vec;
+        stl::size_t _index;
+    };
+
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<T const>;
+
+    concurrent_vector() = default;
+    explicit concurrent_vector(Allocator allocator);
+
+    // Elements are referenced by other threads, so the vector cannot be copied or moved
+    concurrent_vector(concurrent_vector const&) = delete;
+    concurrent_vector& operator=(concurrent_vector const&) = delete;
+
+    ~concurrent_vector();
+
+    // Amount of published elements. All of them can be read safely. Publishes the elements that became
+    // ready since the last call, so its cost is linear in the amount of those.
+    stl::size_t size() const;
+    bool empty() const;
+
+    iterator begin();
+    const_iterator begin() const;
+
+    iterator end();
+    const_iterator end() const;
+
+    T& operator[](stl::size_t i);
+    T const& operator[](stl::size_t i) const;
+
+    // Allocates segments until n elements fit. Safe to call while other threads push
+    void reserve(stl::size_t n);
+
+    // These return the index of the new element. Safe to call from any thread. If constructing the element
+    // throws, nothing is added.
+    stl::size_t push_back(T const& value);
+    stl::size_t push_back(T&& value);
+
+    template<typename... Args>
+    stl::size_t emplace_back(Args&&... args);
+
+    // Destroys all elements, but keeps the segments. Not safe to call while other threads use the vector
+    void clear();
+
+private:
+    static constexpr stl::size_t first_segment_bit = 5;
+    static_assert(stl::size_t(1) << first_segment_bit == first_segment_size, "first_segment_bit does not match");
+    static constexpr stl::size_t max_segments = 64 - first_segment_bit;
+
+    Allocator _allocator;
+    std::atomic<T*> _segments[max_segments] = {};
+    // Slots handed out to pushing threads
+    std::atomic<stl::size_t> _claimed { 0 };
+    // Slots with fully constructed elements, always a prefix of the claimed slots. Only advanced by size()
+    mutable std::atomic<stl::size_t> _published { 0 };
+
+    static stl::size_t segment_of(stl::size_t i);
+    static stl::size_t segment_start(stl::size_t segment);
+    static stl::size_t segment_size(stl::size_t segment);
+    // A segment stores its elements followed by one ready flag per element
+    static stl::size_t segment_bytes(stl::size_t segment);
+    static std::atomic<bool>* ready_flags(T* segment, stl::size_t k);
+
+    T* slot(stl::size_t i) const;
+    // Whether slot i holds a constructed element that may not be published yet
+    bool is_ready(stl::size_t i) const;
+    // Returns the segment, allocating it if no other thread did so yet
+    T* assure_segment(stl::size_t segment);
+    // Claims a slot and constructs the element in it. The constructor must not throw
+    template<typename... Args>
+    stl::size_t emplace_claimed(Args&&... args);
+};
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>::concurrent_vector(Allocator allocator) : _allocator(stl::move(allocator)) {
+
+}
+
+template<typename T, typename Allocator>
+concurrent_vector<T, Allocator>::~concurrent_vector() {
+    clear();
+    for (stl::size_t k = 0; k < max_segments; ++k) {
+        if (T* segment = _segments[k].load(std::memory_order_relaxed)) {
+            _allocator.deallocate_aligned(segment, segment_bytes(k), alignof(T));
+        }
+    }
+}
+
+template<typename T, typename Allocator>
+stl::size_t concurrent_vector<T, Allocator>::size() const {
+    stl::size_t const start = _published.load(std::memory_order_acquire);
+    stl::size_t published = start;
+    while (is_ready(published)) {
+        ++published;
+    }
+
+    // Other readers may advance the prefix at the same time, keep the largest value
+    stl::size_t current = start;
+    while (current < published &&
+        !_published.compare_exchange_weak(current, published, std::memory_order_release, std::memory_order_acquire)) {}
+    return published;
+}
+
+template<typename T, typename Allocator>
+bool concurrent_vector<T, Allocator>::empty() const {
+    return size() == 0;
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::begin() {
+    return iterator(this, 0);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_iterator concurrent_vector<T, Allocator>::begin() const {
+    return const_iterator(this, 0);
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::iterator concurrent_vector<T, Allocator>::end() {
+    return iterator(this, size());
+}
+
+template<typename T, typename Allocator>
+typename concurrent_vector<T, Allocator>::const_iterator concurrent_vector<T, Allocator>::end() const {
+    return const_iterator(this, size());
+}
+
+template<typename T, typename Allocator>
+T& concurrent_vector<T, Allocator>::operator[](stl::size_t i) {
+    STL_ASSERT(i < size(), "concurrent_vector index out of range");
+    return *slot(i);
+}
+
+template<typename T, typename Allocator>
+T const& concurrent_vector<T, Allocator>::operator[](stl::size_t i) const {
+    STL_ASSERT(i < size(), "concurrent_vector index out of range");
+    return *slot(i);
+}
+
+template<typename T, typename Allocator>
+void concurrent_vector<T, Allocator>::reserve(stl::size_t n) {
+    if (n == 0) { return; }
+
+    stl::size_t const last = segment_of(n - 1);
+    for (stl::size_t k = 0; k <= last; ++k) {
+        assure_segment(k);
+    }
+}
+
+template<typename T, typename Allocator>
+stl::size_t concurrent_vector<T, Allocator>::push_back(T const& value) {
+    return emplace_back(value);
+}
+
+template<typename T, typename Allocator>
+stl::size_t concurrent_vector<T, Allocator>::push_back(T&& value) {
+    return emplace_back(stl::move(value));
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+stl::size_t concurrent_vector<T, Allocator>::emplace_back(Args&&... args) {
+    if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+        return emplace_claimed(stl::forward<Args>(args) ...);
+    } else {
+        static_assert(std::is_nothrow_move_constructible_v<T>,
+            "concurrent_vector elements need a nothrow move constructor if their constructor may throw");
+        T value { stl::forward<Args>(args) ... };
+        return emplace_claimed(stl::move(value));
+    }
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+stl::size_t concurrent_vector<T, Allocator>::emplace_claimed(Args&&... args) {
+    // Only claim a slot whose segment exists, so nothing after the claim can fail. Running out of memory
+    // throws here, before anything is claimed. Nothing is published yet, so claiming needs no ordering.
+    stl::size_t i = _claimed.load(std::memory_order_relaxed);
+    T* segment = assure_segment(segment_of(i));
+    // On failure i holds the next free slot, which may be in a later segment
+    while (!_claimed.compare_exchange_weak(i, i + 1, std::memory_order_relaxed)) {
+        segment = assure_segment(segment_of(i));
+    }
+
+    stl::size_t const k = segment_of(i);
+    stl::size_t const offset = i - segment_start(k);
+    new (segment + offset) T { stl::forward<Args>(args) ... };
+
+    // Pairs with the acquire load in is_ready(), size() publishes the slot
+    ready_flags(segment, k)[offset].store(true, std::memory_order_release);
+    return i;
+}
+
+template<typename T, typename Allocator>
+void concurrent_vector<T, Allocator>::clear() {
+    // No push is running, so every claimed slot is ready
+    stl::size_t const n = _claimed.load(std::memory_order_relaxed);
+    for (stl::size_t i = 0; i < n; ++i) {
+        destruct_n(slot(i), 1);
+        stl::size_t const k = segment_of(i);
+        ready_flags(_segments[k].load(std::memory_order_relaxed), k)[i - segment_start(k)].store(false, std::memory_order_relaxed);
+    }
+    _claimed.store(0, std::memory_order_relaxed);
+    _published.store(0, std::memory_order_relaxed);
+}
+
+template<typename T, typename Allocator>
+stl::size_t concurrent_vector<T, Allocator>::segment_of(stl::size_t i) {
+    return detail::highest_bit(i + first_segment_size) - first_segment_bit;
+}
+
+template<typename T, typename Allocator>
+stl::size_t concurrent_vector<T, Allocator>::segment_start(stl::size_t segment) {
+    return (first_segment_size << segment) - first_segment_size;
+}
+
+template<typename T, typename Allocator>
+stl::size_t concurrent_vector<T, Allocator>::segment_size(stl::size_t segment) {
+    return first_segment_size << segment;
+}
+
+template<typename T, typename Allocator>
+stl::size_t concurrent_vector<T, Allocator>::segment_bytes(stl::size_t segment) {
+    return segment_size(segment) * (sizeof(T) + sizeof(std::atomic<bool>));
+}
+
+template<typename T, typename Allocator>
+std::atomic<bool>* concurrent_vector<T, Allocator>::ready_flags(T* segment, stl::size_t k) {
+    return reinterpret_cast<std::atomic<bool>*>(segment + segment_size(k));
+}
+
+template<typename T, typename Allocator>
+T* concurrent_vector<T, Allocator>::slot(stl::size_t i) const {
+    stl::size_t const k = segment_of(i);
+    return _segments[k].load(std::memory_order_acquire) + (i - segment_start(k));
+}
+
+template<typename T, typename Allocator>
+bool concurrent_vector<T, Allocator>::is_ready(stl::size_t i) const {
+    stl::size_t const k = segment_of(i);
+    T* segment = _segments[k].load(std::memory_order_acquire);
+    // The thread that claimed i may not have allocated its segment yet
+    return segment && ready_flags(segment, k)[i - segment_start(k)].load(std::memory_order_acquire);
+}
+
+template<typename T, typename Allocator>
+T* concurrent_vector<T, Allocator>::assure_segment(stl::size_t segment) {
+    T* current = _segments[segment].load(std::memory_order_acquire);
+    if (current) {
+        return current;
+    }
+
+    // Several threads may race to allocate the same segment, only one of them wins
+    T* fresh = static_cast<T*>(_allocator.allocate_aligned(segment_bytes(segment), alignof(T)));
+    std::atomic<bool>* flags = ready_flags(fresh, segment);
+    for (stl::size_t i = 0; i < segment_size(segment); ++i) {
+        new (flags + i) std::atomic<bool> { false };
+    }
+
+    if (_segments[segment].compare_exchange_strong(current, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        return fresh;
+    }
+
+    _allocator.deallocate_aligned(fresh, segment_bytes(segment), alignof(T));
+    return current;
+}
+
+} // namespace stl
+
+#endif
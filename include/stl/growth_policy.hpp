@@ -0,0 +1,73 @@
+#ifndef STL_GROWTH_POLICY_HPP_
+#define STL_GROWTH_POLICY_HPP_
+
+#include <stl/types.hpp>
+#include <stl/allocator.hpp>
+#include <stl/algorithm.hpp>
+
+namespace stl {
+
+// Growth policies pick the new capacity of a container that ran out of space. A policy is a type with
+//     template<typename Allocator>
+//     static stl::size_t next_capacity(stl::size_t capacity, stl::size_t required, stl::size_t element_size,
+//                                      Allocator const& allocator);
+// that returns a capacity of at least required elements.
+
+// Doubles the capacity. Few reallocations, but up to half of the buffer may be unused
+struct grow_2x {
+    template<typename Allocator>
+    static stl::size_t next_capacity(stl::size_t capacity, stl::size_t required, stl::size_t, Allocator const&) {
+        return stl::max(capacity * 2, required);
+    }
+};
+
+// Grows the capacity by half. Wastes less memory than grow_2x in exchange for more reallocations
+struct grow_1_5x {
+    template<typename Allocator>
+    static stl::size_t next_capacity(stl::size_t capacity, stl::size_t required, stl::size_t, Allocator const&) {
+        return stl::max(capacity + capacity / 2, required);
+    }
+};
+
+// Grows by Chunk elements at a time. Never wastes more than Chunk elements, but the amount of reallocations
+// grows linearly with the size. Best combined with an allocator that can expand in place.
+template<stl::size_t Chunk>
+struct grow_by_chunk {
+    static_assert(Chunk > 0, "chunk size must be at least one element");
+
+    template<typename Allocator>
+    static stl::size_t next_capacity(stl::size_t, stl::size_t required, stl::size_t, Allocator const&) {
+        return (required + Chunk - 1) / Chunk * Chunk;
+    }
+};
+
+// Grows like Base, then rounds the buffer up to the size the allocator reserves for it anyway
+// (see allocator_base::good_size()), so the slack of size class allocators becomes usable capacity.
+template<typename Base = grow_2x>
+struct grow_to_size_class {
+    template<typename Allocator>
+    static stl::size_t next_capacity(stl::size_t capacity, stl::size_t required, stl::size_t element_size,
+                                     Allocator const& allocator) {
+        stl::size_t const n = Base::next_capacity(capacity, required, element_size, allocator);
+        return stl::max(n, allocator.good_size(n * element_size) / element_size);
+    }
+};
+
+// Grows like Base, then rounds buffers of a page or more up to a whole number of pages
+template<typename Base = grow_2x>
+struct grow_to_page {
+    template<typename Allocator>
+    static stl::size_t next_capacity(stl::size_t capacity, stl::size_t required, stl::size_t element_size,
+                                     Allocator const& allocator) {
+        stl::size_t const n = Base::next_capacity(capacity, required, element_size, allocator);
+        stl::size_t const bytes = n * element_size;
+        if (bytes < page_size) {
+            return n;
+        }
+        return (bytes + page_size - 1) / page_size * page_size / element_size;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef STL_HEAP_PROFILER_HPP_
+#define STL_HEAP_PROFILER_HPP_
+
+#include <stl/types.hpp>
+
+#include <atomic>
+#include <cstdio>
+
+namespace stl {
+
+// Opt-in sampling profiler for memory allocated through stl::allocator, and so through every container
+// using the default allocator. While running, on average one allocation per sample_interval bytes has its
+// call stack recorded. Profiles of the sampled allocations that are still live can be written at any time
+// to find the call sites that make a long running process grow.
+namespace heap_profiler {
+
+constexpr stl::size_t default_sample_interval = 512 * 1024;
+
+// Starts sampling. Samples from a previous run are discarded
+void start(stl::size_t sample_interval = default_sample_interval);
+// Stops sampling and discards all samples
+void stop();
+bool is_running();
+
+// Writes live samples in the legacy text heap profile format (heap_v2) understood by pprof:
+//     pprof --text <binary> <file>
+void dump(std::FILE* out);
+// Writes live samples grouped by call stack, with symbol names where they are available
+void dump_symbolized(std::FILE* out);
+
+} // namespace heap_profiler
+
+namespace detail {
+
+extern std::atomic<bool> heap_profiler_running;
+
+void heap_profiler_record_allocate(void* ptr, stl::size_t size);
+void heap_profiler_record_deallocate(void* ptr);
+
+} // namespace detail
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef STL_HUGE_PAGE_ALLOCATOR_HPP_
+#define STL_HUGE_PAGE_ALLOCATOR_HPP_
+
+#include <stl/allocator.hpp>
+
+namespace stl {
+
+// Allocator for very large buffers. Requests of at least threshold bytes are mapped straight from the OS
+// in multiples of huge_page_size and use transparent huge pages where available, which cuts down on TLB
+// misses when scanning them. Smaller requests are forwarded to stl::allocator.
+// Freed mappings have their pages released with MADV_DONTNEED and a few of them are kept around
+// to serve later requests of the same size. On platforms without mmap everything goes to stl::allocator.
+class huge_page_allocator : public allocator_base {
+public:
+    static constexpr stl::size_t huge_page_size = 2 * 1024 * 1024;
+    static constexpr stl::size_t default_threshold = huge_page_size;
+
+    huge_page_allocator() = default;
+    explicit huge_page_allocator(stl::size_t threshold);
+
+    virtual ~huge_page_allocator() = default;
+
+    void* allocate(stl::size_t size) override;
+    void deallocate(void* ptr, stl::size_t size) override;
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) override;
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) override;
+
+    // Large blocks are resized with mremap, so growing them never copies any data
+    bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) override;
+    void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) override;
+
+    // Mapped requests are rounded up to a multiple of huge_page_size
+    stl::size_t good_size(stl::size_t size) const override;
+
+    stl::size_t threshold() const;
+
+    // Unmaps all cached mappings
+    static void release_cached_memory();
+
+private:
+    stl::size_t _threshold = default_threshold;
+    stl::allocator _fallback;
+
+    bool is_mapped(stl::size_t size) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef STL_INLINE_ALLOCATOR_HPP_
+#define STL_INLINE_ALLOCATOR_HPP_
+
+#include <stl/allocator.hpp>
+#include <stl/algorithm.hpp>
+#include <stl/utility.hpp>
+
+namespace stl {
+
+// Allocator with N bytes of storage inside the object itself. Allocations are bump allocated from that
+// storage first and go to Parent once it is exhausted. Freeing the most recent inline allocation makes its
+// space available again. Used as a container's allocator, small containers live entirely on the stack:
+//     stl::vector<int, stl::inline_allocator<64 * sizeof(int)>> temp;
+// Since the memory lives inside the allocator, containers using it move their elements one by one
+// instead of stealing the buffer.
+template<stl::size_t N, typename Parent = stl::allocator>
+class inline_allocator : public allocator_base {
+public:
+    static constexpr stl::size_t inline_size = N;
+
+    inline_allocator() = default;
+    explicit inline_allocator(Parent parent) : _parent(stl::move(parent)) {}
+
+    // The buffer cannot be shared, so copies start out empty
+    inline_allocator(inline_allocator const& rhs) : _parent(rhs._parent) {}
+    inline_allocator& operator=(inline_allocator const&) { return *this; }
+
+    virtual ~inline_allocator() = default;
+
+    void* allocate(stl::size_t size) override {
+        return allocate_aligned(size, default_alignment);
+    }
+
+    void deallocate(void* ptr, stl::size_t size) override {
+        deallocate_aligned(ptr, size, default_alignment);
+    }
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) override {
+        if (size == 0) {
+            return nullptr;
+        }
+
+        auto const base = reinterpret_cast<stl::uintptr_t>(_buffer);
+        stl::size_t const offset = ((base + _offset + alignment - 1) & ~(alignment - 1)) - base;
+        if (offset + size <= N) {
+            _offset = offset + size;
+            return _buffer + offset;
+        }
+
+        return _parent.allocate_aligned(size, alignment);
+    }
+
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) override {
+        if (ptr == nullptr || size == 0) { return; }
+
+        if (owns(ptr)) {
+            // Only the most recent allocation can be given back, anything else is reclaimed with the allocator
+            unsigned char* p = static_cast<unsigned char*>(ptr);
+            if (p + size == _buffer + _offset) {
+                _offset = p - _buffer;
+            }
+            return;
+        }
+
+        _parent.deallocate_aligned(ptr, size, alignment);
+    }
+
+    bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) override {
+        if (!owns(ptr)) {
+            return _parent.try_expand(ptr, old_size, new_size);
+        }
+
+        unsigned char* p = static_cast<unsigned char*>(ptr);
+        if (p + old_size != _buffer + _offset || (p - _buffer) + new_size > N) {
+            return false;
+        }
+
+        _offset = (p - _buffer) + new_size;
+        return true;
+    }
+
+    void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) override {
+        if (ptr != nullptr && !owns(ptr)) {
+            return _parent.reallocate(ptr, old_size, new_size);
+        }
+
+        return allocator_base::reallocate(ptr, old_size, new_size);
+    }
+
+    // Requests that can fit in the inline storage are not rounded
+    stl::size_t good_size(stl::size_t size) const override {
+        if (size <= N) {
+            return size;
+        }
+        return _parent.good_size(size);
+    }
+
+    // Whether ptr points into the inline storage
+    bool owns(void const* ptr) const {
+        auto const p = reinterpret_cast<stl::uintptr_t>(ptr);
+        auto const base = reinterpret_cast<stl::uintptr_t>(_buffer);
+        return p >= base && p < base + N;
+    }
+
+private:
+    alignas(default_alignment) unsigned char _buffer[N];
+    stl::size_t _offset = 0;
+    Parent _parent;
+};
+
+template<stl::size_t N, typename Parent>
+struct allocator_traits<inline_allocator<N, Parent>> {
+    static constexpr bool propagate_on_copy_assignment = false;
+    static constexpr bool propagate_on_move_assignment = false;
+    static constexpr bool propagate_on_swap = false;
+    static constexpr bool buffer_survives_move = false;
+
+    static inline_allocator<N, Parent> select_on_copy_construction(inline_allocator<N, Parent> const& allocator) {
+        return allocator;
+    }
+
+    static bool equal(inline_allocator<N, Parent> const& lhs, inline_allocator<N, Parent> const& rhs) {
+        return &lhs == &rhs;
+    }
+};
+
+}
+
+#endif
@@ -3,6 +3,10 @@
 
 #include <stl/types.hpp>
 #include <stl/traits.hpp>
+#include <stl/utility.hpp>
+
+#include <cstring>
+#include <new>
 
 namespace stl {
 
@@ -51,6 +55,44 @@ void destruct_n(OutputIt begin, stl::size_t n) {
     }
 }
 
+// Moves n objects from src to uninitialized memory at dest and destroys the originals. 
+// The ranges may not overlap. Trivially relocatable types are copied with a single memcpy.
+template<typename T>
+void relocate_n(T* dest, T* src, stl::size_t n) {
+    if (n == 0) { return; }
+
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::memcpy(static_cast<void*>(dest), static_cast<void const*>(src), n * sizeof(T));
+    } else {
+        for (stl::size_t i = 0; i < n; ++i) {
+            new (dest + i) T { stl::move(src[i]) };
+            src[i].~T();
+        }
+    }
+}
+
+// Same as relocate_n, but the ranges may overlap. Used to shift elements inside a buffer.
+template<typename T>
+void relocate_overlapping_n(T* dest, T* src, stl::size_t n) {
+    if (n == 0 || dest == src) { return; }
+
+    if constexpr (is_trivially_relocatable_v<T>) {
+        std::memmove(static_cast<void*>(dest), static_cast<void const*>(src), n * sizeof(T));
+    } else if (dest < src) {
+        // Front to back, so every destination slot has already been vacated
+        for (stl::size_t i = 0; i < n; ++i) {
+            new (dest + i) T { stl::move(src[i]) };
+            src[i].~T();
+        }
+    } else {
+        // Back to front for the same reason
+        for (stl::size_t i = n; i > 0; --i) {
+            new (dest + i - 1) T { stl::move(src[i - 1]) };
+            src[i - 1].~T();
+        }
+    }
+}
+
 } // namespace stl
 
 #endif
\ No newline at end of file
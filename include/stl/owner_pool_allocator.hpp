@@ -0,0 +1,30 @@
+#ifndef STL_OWNER_POOL_ALLOCATOR_HPP_
+#define STL_OWNER_POOL_ALLOCATOR_HPP_
+
+#include <stl/allocator.hpp>
+#include <stl/pool_allocator.hpp>
+
+namespace stl {
+
+// Pool allocator for buffers that are created on one thread and destroyed on another, like containers
+// handed from a producer to a consumer. Every thread owns a heap of slabs and blocks always return to the
+// heap they came from. A free on the owning thread goes to a plain free list. A free from any other
+// thread is pushed onto a lock-free list of the owning heap, which the owner takes over in one batch
+// when it runs out of blocks. Neither path takes a mutex.
+// Heaps of exited threads are handed to the next thread that starts allocating.
+// Uses the same size classes as pool_allocator. Larger requests go to stl::default_allocator().
+class owner_pool_allocator : public allocator_base {
+public:
+    static constexpr stl::size_t max_pooled_size = detail::pool_max_size;
+
+    virtual ~owner_pool_allocator() = default;
+
+    void* allocate(stl::size_t size) override;
+    void deallocate(void* ptr, stl::size_t size) override;
+
+    stl::size_t good_size(stl::size_t size) const override;
+};
+
+}
+
+#endif
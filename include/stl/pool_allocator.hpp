@@ -0,0 +1,45 @@
+#ifndef STL_POOL_ALLOCATOR_HPP_
+#define STL_POOL_ALLOCATOR_HPP_
+
+#include <stl/allocator.hpp>
+
+namespace stl {
+
+namespace detail {
+
+// Size classes shared by the pool allocators. Classes go up in steps of 16 bytes until 128 bytes,
+// after that every power of two range is split into 4 classes.
+constexpr stl::size_t pool_size_class_count = 28;
+constexpr stl::size_t pool_max_size = 4096;
+
+// Index of the smallest class that fits size bytes. size must be in [1, pool_max_size]
+stl::size_t pool_size_class(stl::size_t size);
+// Block size of a class
+stl::size_t pool_size_class_size(stl::size_t index);
+
+} // namespace detail
+
+// General purpose allocator for small blocks. Requests are rounded up to a size class and served from
+// slabs shared by the whole process. Every thread keeps a cache of free blocks per size class and
+// exchanges them with a shared depot in batches, so most calls do not take a lock.
+// Requests larger than max_pooled_size are forwarded to stl::default_allocator().
+// All instances share the same pool, so memory can be freed through any instance.
+class pool_allocator : public allocator_base {
+public:
+    static constexpr stl::size_t max_pooled_size = detail::pool_max_size;
+
+    virtual ~pool_allocator() = default;
+
+    void* allocate(stl::size_t size) override;
+    void deallocate(void* ptr, stl::size_t size) override;
+
+    // Same as block_size()
+    stl::size_t good_size(stl::size_t size) const override;
+
+    // Returns the amount of bytes actually reserved for a request of size bytes
+    static stl::size_t block_size(stl::size_t size);
+};
+
+}
+
+#endif
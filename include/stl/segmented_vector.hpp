@@ -0,0 +1,461 @@
+#ifndef STL_SEGMENTED_VECTOR_HPP_
+#define STL_SEGMENTED_VECTOR_HPP_
+
+#include <stl/allocator.hpp>
+#include <stl/vector.hpp>
+#include <stl/span.hpp>
+#include <stl/memory.hpp>
+#include <stl/utility.hpp>
+#include <stl/assert.hpp>
+#include <stl/exception.hpp>
+
+namespace stl {
+
+namespace detail {
+
+// Largest power of two amount of elements that fits in a page, but at least one
+template<typename T>
+constexpr stl::size_t default_block_size() {
+    stl::size_t n = 1;
+    while (n * 2 * sizeof(T) <= page_size) {
+        n *= 2;
+    }
+    return n;
+}
+
+}
+
+// Vector that stores its elements in blocks of BlockSize elements. Growing only allocates a new block,
+// so elements never move and pointers to them stay valid until the element is removed.
+// Iteration is contiguous within a block, block(i) gives direct access to the elements of a single block.
+template<typename T, stl::size_t BlockSize = detail::default_block_size<T>(), typename Allocator = stl::allocator>
+class segmented_vector {
+    static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0, "block size must be a power of two");
+public:
+    using value_type = T;
+
+    static constexpr stl::size_t block_size = BlockSize;
+
+    // U is T for iterator and T const for const_iterator
+    template<typename U>
+    class basic_iterator {
+    public:
+        using value_type = T;
+
+        basic_iterator() = default;
+        basic_iterator(U* const* blocks, stl::size_t index) : _blocks(blocks), _index(index) {}
+
+        // Allows conversion from iterator to const_iterator
+        template<typename V>
+        basic_iterator(basic_iterator<V> const& rhs) : _blocks(rhs._blocks), _index(rhs._index) {}
+
+        U& operator*() const { return _blocks[_index / BlockSize][_index % BlockSize]; }
+        U* operator->() const { return &**this; }
+        U& operator[](stl::ptrdiff_t n) const { return *(*this + n); }
+
+        basic_iterator& operator++() { ++_index; return *this; }
+        basic_iterator operator++(int) { basic_iterator old = *this; ++_index; return old; }
+        basic_iterator& operator--() { --_index; return *this; }
+        basic_iterator operator--(int) { basic_iterator old = *this; --_index; return old; }
+
+        basic_iterator& operator+=(stl::ptrdiff_t n) { _index += n; return *this; }
+        basic_iterator& operator-=(stl::ptrdiff_t n) { _index -= n; return *this; }
+        basic_iterator operator+(stl::ptrdiff_t n) const { return basic_iterator(_blocks, _index + n); }
+        basic_iterator operator-(stl::ptrdiff_t n) const { return basic_iterator(_blocks, _index - n); }
+        stl::ptrdiff_t operator-(basic_iterator rhs) const {
+            return static_cast<stl::ptrdiff_t>(_index) - static_cast<stl::ptrdiff_t>(rhs._index);
+        }
+
+        bool operator==(basic_iterator rhs) const { return _index == rhs._index; }
+        bool operator!=(basic_iterator rhs) const { return _index != rhs._index; }
+        bool operator<(basic_iterator rhs) const { return _index < rhs._index; }
+        bool operator<=(basic_iterator rhs) const { return _index <= rhs._index; }
+        bool operator>(basic_iterator rhs) const { return _index > rhs._index; }
+        bool operator>=(basic_iterator rhs) const { return _index >= rhs._index; }
+
+    private:
+        template<typename V>
+        friend class basic_iterator;
+
+        U* const* _blocks = nullptr;
+        stl::size_t _index = 0;
+    };
+
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<T const>;
+
+    segmented_vector() = default;
+    // Creates an empty vector that allocates its blocks from allocator
+    explicit segmented_vector(Allocator allocator);
+
+    segmented_vector(segmented_vector const& other);
+    segmented_vector(segmented_vector&& other);
+
+    segmented_vector& operator=(segmented_vector const& other);
+    segmented_vector& operator=(segmented_vector&& other);
+
+    ~segmented_vector();
+
+    Allocator& get_allocator();
+    Allocator const& get_allocator() const;
+
+    stl::size_t size() const;
+    stl::size_t capacity() const;
+    bool empty() const;
+
+    iterator begin();
+    const_iterator begin() const;
+
+    iterator end();
+    const_iterator end() const;
+
+    T& operator[](stl::size_t i);
+    T const& operator[](stl::size_t i) const;
+
+    T& at(stl::size_t i);
+    T const& at(stl::size_t i) const;
+
+    T& front();
+    T const& front() const;
+
+    T& back();
+    T const& back() const;
+
+    // Amount of blocks holding elements
+    stl::size_t block_count() const;
+    // Elements stored in block i. All blocks but the last one are full
+    span<T> block(stl::size_t i);
+    span<T const> block(stl::size_t i) const;
+
+    // Allocates blocks until n elements fit
+    void reserve(stl::size_t n);
+
+    void push_back(T const& value);
+    void push_back(T&& value);
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+
+    void pop_back();
+
+    // Destroys all elements, but keeps the blocks for reuse
+    void clear();
+    // Frees blocks that hold no elements
+    void shrink_to_fit();
+
+    void swap(segmented_vector& other);
+
+private:
+    using block_table = stl::vector<T*, Allocator>;
+
+    // The block table holds the only allocator instance, which also allocates the blocks
+    block_table _blocks;
+    stl::size_t _size = 0;
+
+    // Block table for a vector move constructed from other. It only takes over other's blocks if they
+    // stay valid after the move.
+    static block_table take_blocks(segmented_vector& other);
+
+    T* slot(stl::size_t i) const;
+    // Makes sure there is room for one more element
+    void assure_space();
+    void add_block();
+    // Destroys all elements and frees all blocks
+    void release();
+    // Takes over the blocks of other
+    void steal(segmented_vector& other);
+};
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+segmented_vector<T, BlockSize, Allocator>::segmented_vector(Allocator allocator) : _blocks(stl::move(allocator)) {
+
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+segmented_vector<T, BlockSize, Allocator>::segmented_vector(segmented_vector const& other) :
+    _blocks(allocator_traits<Allocator>::select_on_copy_construction(other.get_allocator())) {
+    reserve(other._size);
+    for (T const& value : other) {
+        push_back(value);
+    }
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+segmented_vector<T, BlockSize, Allocator>::segmented_vector(segmented_vector&& other) : _blocks(take_blocks(other)) {
+    if constexpr (!allocator_traits<Allocator>::buffer_survives_move) {
+        // The other vector's blocks live inside its allocator, so we need our own
+        reserve(other._size);
+        for (T& value : other) {
+            push_back(stl::move(value));
+        }
+        other.clear();
+        return;
+    }
+
+    _size = other._size;
+    other._size = 0;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+segmented_vector<T, BlockSize, Allocator>& segmented_vector<T, BlockSize, Allocator>::operator=(segmented_vector const& other) {
+    if (this == &other) return *this;
+
+    if constexpr (allocator_traits<Allocator>::propagate_on_copy_assignment) {
+        release();
+        // Copying the table adopts other's allocator. Its block pointers are not ours, so drop them
+        _blocks = other._blocks;
+        _blocks.clear();
+    }
+
+    clear();
+    reserve(other._size);
+    for (T const& value : other) {
+        push_back(value);
+    }
+
+    return *this;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+segmented_vector<T, BlockSize, Allocator>& segmented_vector<T, BlockSize, Allocator>::operator=(segmented_vector&& other) {
+    if (this == &other) return *this;
+
+    if constexpr (!allocator_traits<Allocator>::propagate_on_move_assignment) {
+        // We cannot take over blocks from an allocator we do not share, move the elements instead
+        if (!allocator_traits<Allocator>::equal(get_allocator(), other.get_allocator())) {
+            clear();
+            reserve(other._size);
+            for (T& value : other) {
+                push_back(stl::move(value));
+            }
+            other.clear();
+            return *this;
+        }
+    }
+
+    // Moving the table takes over other's allocator if the traits say so
+    release();
+    steal(other);
+
+    return *this;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+segmented_vector<T, BlockSize, Allocator>::~segmented_vector() {
+    release();
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+Allocator& segmented_vector<T, BlockSize, Allocator>::get_allocator() {
+    return _blocks.get_allocator();
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+Allocator const& segmented_vector<T, BlockSize, Allocator>::get_allocator() const {
+    return _blocks.get_allocator();
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+stl::size_t segmented_vector<T, BlockSize, Allocator>::size() const {
+    return _size;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+stl::size_t segmented_vector<T, BlockSize, Allocator>::capacity() const {
+    return _blocks.size() * BlockSize;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+bool segmented_vector<T, BlockSize, Allocator>::empty() const {
+    return _size == 0;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+typename segmented_vector<T, BlockSize, Allocator>::iterator segmented_vector<T, BlockSize, Allocator>::begin() {
+    return iterator(_blocks.data(), 0);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+typename segmented_vector<T, BlockSize, Allocator>::const_iterator segmented_vector<T, BlockSize, Allocator>::begin() const {
+    return const_iterator(_blocks.data(), 0);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+typename segmented_vector<T, BlockSize, Allocator>::iterator segmented_vector<T, BlockSize, Allocator>::end() {
+    return iterator(_blocks.data(), _size);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+typename segmented_vector<T, BlockSize, Allocator>::const_iterator segmented_vector<T, BlockSize, Allocator>::end() const {
+    return const_iterator(_blocks.data(), _size);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T& segmented_vector<T, BlockSize, Allocator>::operator[](stl::size_t i) {
+    STL_ASSERT(i < _size, "segmented_vector index out of range");
+    return *slot(i);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T const& segmented_vector<T, BlockSize, Allocator>::operator[](stl::size_t i) const {
+    STL_ASSERT(i < _size, "segmented_vector index out of range");
+    return *slot(i);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T& segmented_vector<T, BlockSize, Allocator>::at(stl::size_t i) {
+    if (i >= _size) throw std::out_of_range("segmented_vector index out of range");
+    return *slot(i);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T const& segmented_vector<T, BlockSize, Allocator>::at(stl::size_t i) const {
+    if (i >= _size) throw std::out_of_range("segmented_vector index out of range");
+    return *slot(i);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T& segmented_vector<T, BlockSize, Allocator>::front() {
+    STL_ASSERT(!empty(), "front() called on empty segmented_vector");
+    return *slot(0);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T const& segmented_vector<T, BlockSize, Allocator>::front() const {
+    STL_ASSERT(!empty(), "front() called on empty segmented_vector");
+    return *slot(0);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T& segmented_vector<T, BlockSize, Allocator>::back() {
+    STL_ASSERT(!empty(), "back() called on empty segmented_vector");
+    return *slot(_size - 1);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T const& segmented_vector<T, BlockSize, Allocator>::back() const {
+    STL_ASSERT(!empty(), "back() called on empty segmented_vector");
+    return *slot(_size - 1);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+stl::size_t segmented_vector<T, BlockSize, Allocator>::block_count() const {
+    return (_size + BlockSize - 1) / BlockSize;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+span<T> segmented_vector<T, BlockSize, Allocator>::block(stl::size_t i) {
+    STL_ASSERT(i < block_count(), "segmented_vector block index out of range");
+    return span<T>(_blocks[i], stl::min(BlockSize, _size - i * BlockSize));
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+span<T const> segmented_vector<T, BlockSize, Allocator>::block(stl::size_t i) const {
+    STL_ASSERT(i < block_count(), "segmented_vector block index out of range");
+    return span<T const>(_blocks[i], stl::min(BlockSize, _size - i * BlockSize));
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::reserve(stl::size_t n) {
+    while (capacity() < n) {
+        add_block();
+    }
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::push_back(T const& value) {
+    assure_space();
+    new (slot(_size)) T { value };
+    _size += 1;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::push_back(T&& value) {
+    assure_space();
+    new (slot(_size)) T { stl::move(value) };
+    _size += 1;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+template<typename... Args>
+T& segmented_vector<T, BlockSize, Allocator>::emplace_back(Args&&... args) {
+    assure_space();
+    T* ptr = new (slot(_size)) T { stl::forward<Args>(args) ... };
+    _size += 1;
+
+    return *ptr;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::pop_back() {
+    STL_ASSERT(!empty(), "pop_back() called on empty segmented_vector");
+    destruct_n(slot(_size - 1), 1);
+    _size -= 1;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::clear() {
+    for (stl::size_t i = 0; i < block_count(); ++i) {
+        destruct_n(_blocks[i], stl::min(BlockSize, _size - i * BlockSize));
+    }
+    _size = 0;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::shrink_to_fit() {
+    while (_blocks.size() > block_count()) {
+        get_allocator().deallocate_aligned(_blocks.back(), BlockSize * sizeof(T), alignof(T));
+        _blocks.pop_back();
+    }
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::swap(segmented_vector& other) {
+    segmented_vector tmp = stl::move(other);
+    other = stl::move(*this);
+    *this = stl::move(tmp);
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+T* segmented_vector<T, BlockSize, Allocator>::slot(stl::size_t i) const {
+    // BlockSize is a power of two, so this is a shift and a mask
+    return _blocks[i / BlockSize] + i % BlockSize;
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::assure_space() {
+    if (_size == capacity()) {
+        add_block();
+    }
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::add_block() {
+    _blocks.push_back(static_cast<T*>(get_allocator().allocate_aligned(BlockSize * sizeof(T), alignof(T))));
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::release() {
+    clear();
+    shrink_to_fit();
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+typename segmented_vector<T, BlockSize, Allocator>::block_table segmented_vector<T, BlockSize, Allocator>::take_blocks(segmented_vector& other) {
+    if constexpr (allocator_traits<Allocator>::buffer_survives_move) {
+        return stl::move(other._blocks);
+    } else {
+        return block_table(stl::move(other.get_allocator()));
+    }
+}
+
+template<typename T, stl::size_t BlockSize, typename Allocator>
+void segmented_vector<T, BlockSize, Allocator>::steal(segmented_vector& other) {
+    _blocks = stl::move(other._blocks);
+    _size = other._size;
+    other._size = 0;
+}
+
+} // namespace stl
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef STL_SMALL_VECTOR_HPP_
+#define STL_SMALL_VECTOR_HPP_
+
+#include <stl/vector.hpp>
+#include <stl/allocator.hpp>
+#include <stl/utility.hpp>
+
+#include <cstring>
+
+namespace stl {
+
+namespace detail {
+
+// Holds the allocator a small_vector spills to. stl::allocator has no state, so it is not stored at all
+template<typename Allocator>
+class spill_allocator_holder {
+public:
+    spill_allocator_holder() = default;
+    explicit spill_allocator_holder(Allocator allocator) : _allocator(stl::move(allocator)) {}
+
+    Allocator& spill_allocator() { return _allocator; }
+    Allocator const& spill_allocator() const { return _allocator; }
+
+private:
+    Allocator _allocator;
+};
+
+template<>
+class spill_allocator_holder<stl::allocator> {
+public:
+    spill_allocator_holder() = default;
+    explicit spill_allocator_holder(stl::allocator) {}
+
+    stl::allocator spill_allocator() const { return stl::allocator(); }
+};
+
+// Allocator of a small_vector. Unlike inline_allocator it is not polymorphic and only tracks whether its
+// buffer is in use, since a vector holds at most one buffer at a time that is not being replaced. This
+// keeps small_vector<T, N> at the size of the inline elements plus a vector's pointer, size and capacity.
+template<typename T, stl::size_t N, typename Allocator>
+class small_buffer_allocator : public spill_allocator_holder<Allocator> {
+public:
+    static constexpr stl::size_t inline_size = N * sizeof(T);
+
+    small_buffer_allocator() = default;
+    explicit small_buffer_allocator(Allocator allocator) : spill_allocator_holder<Allocator>(stl::move(allocator)) {}
+
+    // The buffer cannot be shared, so copies start out empty
+    small_buffer_allocator(small_buffer_allocator const& rhs) : spill_allocator_holder<Allocator>(rhs) {}
+    small_buffer_allocator& operator=(small_buffer_allocator const&) { return *this; }
+
+    void* allocate(stl::size_t size) {
+        return allocate_aligned(size, default_alignment);
+    }
+
+    void deallocate(void* ptr, stl::size_t size) {
+        deallocate_aligned(ptr, size, default_alignment);
+    }
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) {
+        if (size == 0) {
+            return nullptr;
+        }
+
+        if (!_in_use && size <= inline_size && alignment <= alignof(T)) {
+            _in_use = true;
+            return _buffer;
+        }
+
+        return this->spill_allocator().allocate_aligned(size, alignment);
+    }
+
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) {
+        if (ptr == nullptr || size == 0) { return; }
+
+        if (owns(ptr)) {
+            _in_use = false;
+            return;
+        }
+
+        this->spill_allocator().deallocate_aligned(ptr, size, alignment);
+    }
+
+    bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+        if (!owns(ptr)) {
+            return this->spill_allocator().try_expand(ptr, old_size, new_size);
+        }
+        return new_size <= inline_size;
+    }
+
+    void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+        if (ptr != nullptr && !owns(ptr)) {
+            return this->spill_allocator().reallocate(ptr, old_size, new_size);
+        }
+
+        if (ptr != nullptr && try_expand(ptr, old_size, new_size)) {
+            return ptr;
+        }
+
+        void* new_ptr = allocate(new_size);
+        if (ptr != nullptr) {
+            if (new_ptr) {
+                std::memcpy(new_ptr, ptr, stl::min(old_size, new_size));
+            }
+            deallocate(ptr, old_size);
+        }
+        return new_ptr;
+    }
+
+    // Requests that can fit in the inline storage are not rounded
+    stl::size_t good_size(stl::size_t size) const {
+        if (size <= inline_size) {
+            return size;
+        }
+        return this->spill_allocator().good_size(size);
+    }
+
+    // Whether ptr points into the inline storage
+    bool owns(void const* ptr) const {
+        auto const p = reinterpret_cast<stl::uintptr_t>(ptr);
+        auto const base = reinterpret_cast<stl::uintptr_t>(_buffer);
+        return p >= base && p < base + inline_size;
+    }
+
+private:
+    alignas(T) unsigned char _buffer[inline_size];
+    bool _in_use = false;
+};
+
+}
+
+template<typename T, stl::size_t N, typename Allocator>
+struct allocator_traits<detail::small_buffer_allocator<T, N, Allocator>> {
+    static constexpr bool propagate_on_copy_assignment = false;
+    static constexpr bool propagate_on_move_assignment = false;
+    static constexpr bool propagate_on_swap = false;
+    static constexpr bool buffer_survives_move = false;
+
+    static detail::small_buffer_allocator<T, N, Allocator> select_on_copy_construction(
+        detail::small_buffer_allocator<T, N, Allocator> const& allocator) {
+        return allocator;
+    }
+
+    static bool equal(detail::small_buffer_allocator<T, N, Allocator> const& lhs,
+        detail::small_buffer_allocator<T, N, Allocator> const& rhs) {
+        return &lhs == &rhs;
+    }
+};
+
+// Vector that stores up to N elements inside the object itself and only allocates from Allocator once it
+// grows past that. Has the same interface as stl::vector, GrowthPolicy applies once it spills to the heap.
+// Moving a small_vector moves its elements one by one, since inline elements cannot be handed over.
+// The object is the N elements plus a pointer, size, capacity and an in-use flag, and Allocator if it has
+// state. small_vector<int, 8> is 64 bytes, a single cache line.
+template<typename T, stl::size_t N, typename Allocator = stl::allocator, typename GrowthPolicy = stl::grow_2x>
+class small_vector : public vector<T, detail::small_buffer_allocator<T, N, Allocator>, GrowthPolicy> {
+    static_assert(N > 0, "small_vector needs an inline capacity of at least one element");
+    using base = vector<T, detail::small_buffer_allocator<T, N, Allocator>, GrowthPolicy>;
+public:
+    static constexpr stl::size_t inline_capacity = N;
+
+    using base::base;
+
+    small_vector();
+    // Creates an empty small_vector that spills to allocator
+    explicit small_vector(Allocator allocator);
+
+    // Whether the elements are stored in the inline buffer
+    bool is_inline() const;
+};
+
+template<typename T, stl::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector() {
+    // Claim the whole inline buffer up front, so the first N insertions never reallocate
+    this->reserve(N);
+}
+
+template<typename T, stl::size_t N, typename Allocator, typename GrowthPolicy>
+small_vector<T, N, Allocator, GrowthPolicy>::small_vector(Allocator allocator) :
+    base(detail::small_buffer_allocator<T, N, Allocator>(stl::move(allocator))) {
+    this->reserve(N);
+}
+
+template<typename T, stl::size_t N, typename Allocator, typename GrowthPolicy>
+bool small_vector<T, N, Allocator, GrowthPolicy>::is_inline() const {
+    return this->data() == nullptr || this->get_allocator().owns(this->data());
+}
+
+}
+
+#endif
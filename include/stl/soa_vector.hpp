@@ -0,0 +1,340 @@
+#ifndef STL_SOA_VECTOR_HPP_
+#define STL_SOA_VECTOR_HPP_
+
+#include <stl/vector.hpp>
+#include <stl/tuple.hpp>
+#include <stl/span.hpp>
+#include <stl/utility.hpp>
+#include <stl/assert.hpp>
+#include <stl/exception.hpp>
+
+namespace stl {
+
+// Structure of arrays: every field Ts is stored in its own stl::vector, so loops that only touch a few
+// fields only pull those fields into the cache. Rows are accessed as tuples of references:
+//     stl::soa_vector<vec3, vec3, float> particles;
+//     particles.push_back(position, velocity, lifetime);
+//     for (auto [position, velocity, lifetime] : particles) { ... }
+// column<I>() gives a span over a single field, which is what tight (vectorizable) loops should use.
+template<typename... Ts>
+class soa_vector {
+    static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one column");
+public:
+    using reference = tuple<Ts&...>;
+    using const_reference = tuple<Ts const&...>;
+
+    template<stl::size_t I>
+    using column_type = typename pack_element<I, Ts...>::type;
+
+    static constexpr stl::size_t column_count = sizeof...(Ts);
+
+    // Iterates over rows. Dereferencing returns a tuple of references by value
+    template<typename Soa, typename Reference>
+    class basic_iterator {
+    public:
+        basic_iterator(Soa* soa, stl::size_t index) : _soa(soa), _index(index) {}
+
+        Reference operator*() const { return (*_soa)[_index]; }
+
+        basic_iterator& operator++() { ++_index; return *this; }
+        basic_iterator operator++(int) { basic_iterator old = *this; ++_index; return old; }
+        basic_iterator& operator--() { --_index; return *this; }
+        basic_iterator operator--(int) { basic_iterator old = *this; --_index; return old; }
+
+        bool operator==(basic_iterator rhs) const { return _index == rhs._index; }
+        bool operator!=(basic_iterator rhs) const { return _index != rhs._index; }
+
+        stl::size_t get_index() const { return _index; }
+
+    private:
+        Soa* _soa;
+        stl::size_t _index;
+    };
+
+    using iterator = basic_iterator<soa_vector, reference>;
+    using const_iterator = basic_iterator<soa_vector const, const_reference>;
+
+    soa_vector() = default;
+
+    stl::size_t size() const;
+    stl::size_t capacity() const;
+    bool empty() const;
+
+    iterator begin();
+    const_iterator begin() const;
+
+    iterator end();
+    const_iterator end() const;
+
+    reference operator[](stl::size_t i);
+    const_reference operator[](stl::size_t i) const;
+
+    reference at(stl::size_t i);
+    const_reference at(stl::size_t i) const;
+
+    reference front();
+    const_reference front() const;
+
+    reference back();
+    const_reference back() const;
+
+    // All values of field I, one per row
+    template<stl::size_t I>
+    span<column_type<I>> column();
+    template<stl::size_t I>
+    span<column_type<I> const> column() const;
+
+    void reserve(stl::size_t n);
+    // Resizes every column and adds default constructed rows at the end. If a constructor throws, no row is added
+    void resize(stl::size_t n);
+
+    // Adds a row. If copying or moving a value throws, no row is added
+    void push_back(Ts const&... values);
+    void push_back(Ts&&... values);
+
+    void pop_back();
+
+    // Erases row i and shifts the rows behind it forward. Rows are moved column by column, so every column
+    // type needs a nothrow move constructor.
+    void erase(stl::size_t i);
+    // Erases row i by moving the last row into its place. Does not keep the order of rows. Has the same
+    // requirements as erase()
+    void unordered_erase(stl::size_t i);
+
+    void clear();
+    void shrink_to_fit();
+
+private:
+    using indices = make_index_sequence<sizeof...(Ts)>;
+
+    tuple<vector<Ts>...> _columns;
+
+    template<stl::size_t... Is>
+    reference row(stl::size_t i, index_sequence<Is...>);
+    template<stl::size_t... Is>
+    const_reference row(stl::size_t i, index_sequence<Is...>) const;
+
+    // Calls f on every column
+    template<typename F, stl::size_t... Is>
+    void for_each_column(F&& f, index_sequence<Is...>);
+
+    // Makes room for n rows in every column, growing the capacity the way push_back() on a column would
+    void grow_rows(stl::size_t n);
+
+    template<typename... Us, stl::size_t... Is>
+    void push_back_impl(index_sequence<Is...>, Us&&... values);
+};
+
+template<typename... Ts>
+stl::size_t soa_vector<Ts...>::size() const {
+    return stl::get<0>(_columns).size();
+}
+
+template<typename... Ts>
+stl::size_t soa_vector<Ts...>::capacity() const {
+    return stl::get<0>(_columns).capacity();
+}
+
+template<typename... Ts>
+bool soa_vector<Ts...>::empty() const {
+    return size() == 0;
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::iterator soa_vector<Ts...>::begin() {
+    return iterator(this, 0);
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::const_iterator soa_vector<Ts...>::begin() const {
+    return const_iterator(this, 0);
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::iterator soa_vector<Ts...>::end() {
+    return iterator(this, size());
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::const_iterator soa_vector<Ts...>::end() const {
+    return const_iterator(this, size());
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::reference soa_vector<Ts...>::operator[](stl::size_t i) {
+    STL_ASSERT(i < size(), "soa_vector index out of range");
+    return row(i, indices{});
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::operator[](stl::size_t i) const {
+    STL_ASSERT(i < size(), "soa_vector index out of range");
+    return row(i, indices{});
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::reference soa_vector<Ts...>::at(stl::size_t i) {
+    if (i >= size()) throw std::out_of_range("soa_vector index out of range");
+    return row(i, indices{});
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::at(stl::size_t i) const {
+    if (i >= size()) throw std::out_of_range("soa_vector index out of range");
+    return row(i, indices{});
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::reference soa_vector<Ts...>::front() {
+    STL_ASSERT(!empty(), "front() called on empty soa_vector");
+    return row(0, indices{});
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::front() const {
+    STL_ASSERT(!empty(), "front() called on empty soa_vector");
+    return row(0, indices{});
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::reference soa_vector<Ts...>::back() {
+    STL_ASSERT(!empty(), "back() called on empty soa_vector");
+    return row(size() - 1, indices{});
+}
+
+template<typename... Ts>
+typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::back() const {
+    STL_ASSERT(!empty(), "back() called on empty soa_vector");
+    return row(size() - 1, indices{});
+}
+
+template<typename... Ts>
+template<stl::size_t I>
+span<typename soa_vector<Ts...>::template column_type<I>> soa_vector<Ts...>::column() {
+    auto& col = stl::get<I>(_columns);
+    return span<column_type<I>>(col.data(), col.size());
+}
+
+template<typename... Ts>
+template<stl::size_t I>
+span<typename soa_vector<Ts...>::template column_type<I> const> soa_vector<Ts...>::column() const {
+    auto const& col = stl::get<I>(_columns);
+    return span<column_type<I> const>(col.data(), col.size());
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::reserve(stl::size_t n) {
+    for_each_column([n](auto& col) { col.reserve(n); }, indices{});
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::resize(stl::size_t n) {
+    stl::size_t const old_size = size();
+    // Running out of memory throws here, before any column has new rows
+    reserve(n);
+
+    stl::size_t resized = 0;
+    try {
+        for_each_column([n, &resized](auto& col) { col.resize(n); ++resized; }, indices{});
+    } catch (...) {
+        // Drop the rows added to the columns before the one that threw
+        stl::size_t column = 0;
+        for_each_column([old_size, resized, &column](auto& col) {
+            if (column++ < resized) {
+                col.erase(col.begin() + old_size, col.end());
+            }
+        }, indices{});
+        throw;
+    }
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::push_back(Ts const&... values) {
+    push_back_impl(indices{}, values...);
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::push_back(Ts&&... values) {
+    push_back_impl(indices{}, stl::move(values)...);
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::pop_back() {
+    STL_ASSERT(!empty(), "pop_back() called on empty soa_vector");
+    for_each_column([](auto& col) { col.pop_back(); }, indices{});
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::erase(stl::size_t i) {
+    static_assert((std::is_nothrow_move_constructible_v<Ts> && ...),
+        "soa_vector::erase() needs nothrow move constructible columns, or a throw could leave them with different sizes");
+    STL_ASSERT(i < size(), "soa_vector index out of range");
+    for_each_column([i](auto& col) { col.erase(col.begin() + i); }, indices{});
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::unordered_erase(stl::size_t i) {
+    static_assert((std::is_nothrow_move_constructible_v<Ts> && ...),
+        "soa_vector::unordered_erase() needs nothrow move constructible columns, or a throw could leave them with different sizes");
+    STL_ASSERT(i < size(), "soa_vector index out of range");
+    for_each_column([i](auto& col) { col.unordered_erase(col.begin() + i); }, indices{});
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::clear() {
+    for_each_column([](auto& col) { col.clear(); }, indices{});
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::shrink_to_fit() {
+    for_each_column([](auto& col) { col.shrink_to_fit(); }, indices{});
+}
+
+template<typename... Ts>
+template<stl::size_t... Is>
+typename soa_vector<Ts...>::reference soa_vector<Ts...>::row(stl::size_t i, index_sequence<Is...>) {
+    return reference(stl::get<Is>(_columns)[i] ...);
+}
+
+template<typename... Ts>
+template<stl::size_t... Is>
+typename soa_vector<Ts...>::const_reference soa_vector<Ts...>::row(stl::size_t i, index_sequence<Is...>) const {
+    return const_reference(stl::get<Is>(_columns)[i] ...);
+}
+
+template<typename... Ts>
+template<typename F, stl::size_t... Is>
+void soa_vector<Ts...>::for_each_column(F&& f, index_sequence<Is...>) {
+    (f(stl::get<Is>(_columns)), ...);
+}
+
+template<typename... Ts>
+void soa_vector<Ts...>::grow_rows(stl::size_t n) {
+    // The columns use the default growth policy of stl::vector
+    for_each_column([n](auto& col) {
+        if (col.capacity() < n) {
+            using column = remove_reference_t<decltype(col)>;
+            col.reserve(grow_2x::next_capacity(col.capacity(), n, sizeof(typename column::value_type), col.get_allocator()));
+        }
+    }, indices{});
+}
+
+template<typename... Ts>
+template<typename... Us, stl::size_t... Is>
+void soa_vector<Ts...>::push_back_impl(index_sequence<Is...>, Us&&... values) {
+    // Running out of memory throws here, before any column has the new row
+    grow_rows(size() + 1);
+
+    // Only constructing the values can throw now. If one does, drop the values added to the columns before it
+    stl::size_t pushed = 0;
+    try {
+        ((stl::get<Is>(_columns).push_back(stl::forward<Us>(values)), ++pushed), ...);
+    } catch (...) {
+        ((Is < pushed ? stl::get<Is>(_columns).pop_back() : void()), ...);
+        throw;
+    }
+}
+
+} // namespace stl
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stl/iterator_traits.hpp>
 #include <stl/traits.hpp>
+#include <stl/assert.hpp>
 
 namespace stl {
 
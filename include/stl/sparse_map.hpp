@@ -0,0 +1,260 @@
+#ifndef STL_SPARSE_MAP_HPP_
+#define STL_SPARSE_MAP_HPP_
+
+#include <stl/sparse_set.hpp>
+#include <stl/vector.hpp>
+#include <stl/span.hpp>
+#include <stl/tuple.hpp>
+#include <stl/utility.hpp>
+#include <stl/assert.hpp>
+#include <stl/exception.hpp>
+
+namespace stl {
+
+// Maps ids to values, built on sparse_set. The values are stored packed in an array parallel to the
+// sparse_set's direct array, so the value of the id at index i is at index i as well. Erasing keeps both
+// arrays in lockstep, and iterating all values is a linear scan over contiguous memory.
+// IndexBits enables generational ids, see sparse_set.
+template<typename Id, typename V, size_t IndexBits = sizeof(Id) * 8>
+class sparse_map {
+public:
+    using key_type = Id;
+    using mapped_type = V;
+    using set_type = sparse_set<Id, IndexBits>;
+
+    // Iterates over (id, value) pairs, dereferencing gives a tuple<Id, Value&> by value
+    template<typename Map, typename Value>
+    class basic_iterator {
+    public:
+        basic_iterator(Map* map, size_t index) : _map(map), _index(index) {}
+
+        tuple<Id, Value&> operator*() const {
+            return tuple<Id, Value&>(_map->id_at(_index), _map->_values[_index]);
+        }
+
+        basic_iterator& operator++() { ++_index; return *this; }
+        basic_iterator operator++(int) { basic_iterator old = *this; ++_index; return old; }
+
+        bool operator==(basic_iterator rhs) const { return _index == rhs._index; }
+        bool operator!=(basic_iterator rhs) const { return _index != rhs._index; }
+
+        size_t get_index() const { return _index; }
+
+    private:
+        Map* _map;
+        size_t _index;
+    };
+
+    using iterator = basic_iterator<sparse_map, V>;
+    using const_iterator = basic_iterator<sparse_map const, V const>;
+
+    sparse_map() = default;
+
+    size_t size() const;
+    bool empty() const;
+
+    iterator begin();
+    const_iterator begin() const;
+
+    iterator end();
+    const_iterator end() const;
+
+    bool contains(Id id) const;
+    // Returns a pointer to the value of id, or nullptr if id is not in the map
+    V* find(Id id);
+    V const* find(Id id) const;
+
+    V& at(Id id);
+    V const& at(Id id) const;
+
+    // Adds id with a value constructed from args. id must not be in the map yet
+    template<typename... Args>
+    V& emplace(Id id, Args&&... args);
+    V& insert(Id id, V const& value);
+    V& insert(Id id, V&& value);
+
+    // Erases id and its value by moving the last entry into its slot. Returns whether id was in the map
+    bool erase(Id id);
+    // Erases all entries for which pred(id, value) returns true, in a single pass that keeps the order of
+    // the remaining entries. Returns the amount of erased entries. If pred throws, the entries it returned
+    // true for so far are erased and all others are kept.
+    template<typename Pred>
+    size_t remove_if(Pred pred);
+
+    void clear();
+
+    // The ids, in the same order as values()
+    set_type const& ids() const;
+    span<V> values();
+    span<V const> values() const;
+
+    // Index of id in the packed arrays, only valid if id is in the map
+    size_t index_of(Id id) const;
+    Id id_at(size_t index) const;
+
+private:
+    template<typename Map, typename Value>
+    friend class basic_iterator;
+
+    set_type _ids;
+    vector<V> _values;
+};
+
+template<typename Id, typename V, size_t IndexBits>
+size_t sparse_map<Id, V, IndexBits>::size() const {
+    return _values.size();
+}
+
+template<typename Id, typename V, size_t IndexBits>
+bool sparse_map<Id, V, IndexBits>::empty() const {
+    return _values.empty();
+}
+
+template<typename Id, typename V, size_t IndexBits>
+typename sparse_map<Id, V, IndexBits>::iterator sparse_map<Id, V, IndexBits>::begin() {
+    return iterator(this, 0);
+}
+
+template<typename Id, typename V, size_t IndexBits>
+typename sparse_map<Id, V, IndexBits>::const_iterator sparse_map<Id, V, IndexBits>::begin() const {
+    return const_iterator(this, 0);
+}
+
+template<typename Id, typename V, size_t IndexBits>
+typename sparse_map<Id, V, IndexBits>::iterator sparse_map<Id, V, IndexBits>::end() {
+    return iterator(this, size());
+}
+
+template<typename Id, typename V, size_t IndexBits>
+typename sparse_map<Id, V, IndexBits>::const_iterator sparse_map<Id, V, IndexBits>::end() const {
+    return const_iterator(this, size());
+}
+
+template<typename Id, typename V, size_t IndexBits>
+bool sparse_map<Id, V, IndexBits>::contains(Id id) const {
+    return _ids.find(id) != _ids.end();
+}
+
+template<typename Id, typename V, size_t IndexBits>
+V* sparse_map<Id, V, IndexBits>::find(Id id) {
+    auto it = _ids.find(id);
+    if (it == _ids.end()) return nullptr;
+    return &_values[it.get_index()];
+}
+
+template<typename Id, typename V, size_t IndexBits>
+V const* sparse_map<Id, V, IndexBits>::find(Id id) const {
+    auto it = _ids.find(id);
+    if (it == _ids.end()) return nullptr;
+    return &_values[it.get_index()];
+}
+
+template<typename Id, typename V, size_t IndexBits>
+V& sparse_map<Id, V, IndexBits>::at(Id id) {
+    V* value = find(id);
+    if (!value) throw std::out_of_range("id not in sparse_map");
+    return *value;
+}
+
+template<typename Id, typename V, size_t IndexBits>
+V const& sparse_map<Id, V, IndexBits>::at(Id id) const {
+    V const* value = find(id);
+    if (!value) throw std::out_of_range("id not in sparse_map");
+    return *value;
+}
+
+template<typename Id, typename V, size_t IndexBits>
+template<typename... Args>
+V& sparse_map<Id, V, IndexBits>::emplace(Id id, Args&&... args) {
+    // The value is constructed first, so a throwing constructor leaves both arrays untouched. The set
+    // asserts that id is not in it yet. Both arrays grow by one, so the indices stay equal
+    V& value = _values.emplace_back(stl::forward<Args>(args) ...);
+    try {
+        _ids.insert(id);
+    } catch (...) {
+        _values.pop_back();
+        throw;
+    }
+    return value;
+}
+
+template<typename Id, typename V, size_t IndexBits>
+V& sparse_map<Id, V, IndexBits>::insert(Id id, V const& value) {
+    return emplace(id, value);
+}
+
+template<typename Id, typename V, size_t IndexBits>
+V& sparse_map<Id, V, IndexBits>::insert(Id id, V&& value) {
+    return emplace(id, stl::move(value));
+}
+
+template<typename Id, typename V, size_t IndexBits>
+bool sparse_map<Id, V, IndexBits>::erase(Id id) {
+    auto it = _ids.find(id);
+    if (it == _ids.end()) return false;
+
+    // Both arrays move their last entry into the erased slot. The values go first, since moving them is
+    // the only step that can throw
+    size_t const index = it.get_index();
+    _values.unordered_erase(_values.begin() + index);
+    _ids.erase_at(index);
+    return true;
+}
+
+template<typename Id, typename V, size_t IndexBits>
+template<typename Pred>
+size_t sparse_map<Id, V, IndexBits>::remove_if(Pred pred) {
+    // compact() moves every value before its id, and relies on that move to finish the pass if pred throws
+    static_assert(std::is_nothrow_move_assignable_v<V>, "sparse_map::remove_if requires a nothrow move assignable value type");
+
+    size_t erased = 0;
+    try {
+        erased = _ids.compact(
+            [this, &pred](size_t i) { return pred(_ids.direct[i], _values[i]); },
+            [this](size_t from, size_t to) { _values[to] = stl::move(_values[from]); });
+    } catch (...) {
+        // pred threw. The set kept the entries it did not see yet, drop the values the set dropped
+        _values.erase(_values.begin() + _ids.size(), _values.end());
+        throw;
+    }
+
+    _values.erase(_values.begin() + _ids.size(), _values.end());
+    return erased;
+}
+
+template<typename Id, typename V, size_t IndexBits>
+void sparse_map<Id, V, IndexBits>::clear() {
+    _ids.clear();
+    _values.clear();
+}
+
+template<typename Id, typename V, size_t IndexBits>
+typename sparse_map<Id, V, IndexBits>::set_type const& sparse_map<Id, V, IndexBits>::ids() const {
+    return _ids;
+}
+
+template<typename Id, typename V, size_t IndexBits>
+span<V> sparse_map<Id, V, IndexBits>::values() {
+    return span<V>(_values.data(), _values.size());
+}
+
+template<typename Id, typename V, size_t IndexBits>
+span<V const> sparse_map<Id, V, IndexBits>::values() const {
+    return span<V const>(_values.data(), _values.size());
+}
+
+template<typename Id, typename V, size_t IndexBits>
+size_t sparse_map<Id, V, IndexBits>::index_of(Id id) const {
+    auto it = _ids.find(id);
+    STL_ASSERT(it != _ids.end(), "id not in sparse_map");
+    return it.get_index();
+}
+
+template<typename Id, typename V, size_t IndexBits>
+Id sparse_map<Id, V, IndexBits>::id_at(size_t index) const {
+    return _ids.direct[index];
+}
+
+} // namespace stl
+
+#endif
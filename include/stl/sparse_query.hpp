@@ -0,0 +1,214 @@
+#ifndef STL_SPARSE_QUERY_HPP_
+#define STL_SPARSE_QUERY_HPP_
+
+#include <stl/sparse_set.hpp>
+#include <stl/sparse_map.hpp>
+#include <stl/tuple.hpp>
+#include <stl/utility.hpp>
+
+#include <type_traits>
+
+namespace stl {
+
+namespace detail {
+
+// Describes how a query reads one of its sources. A sparse_set only filters ids, a sparse_map also
+// contributes a reference to its value, returned by value().
+template<typename Source>
+struct query_source;
+
+template<typename T, size_t Bits, typename Allocator>
+struct query_source<sparse_set<T, Bits, Allocator>> {
+    using id_type = T;
+    using components = tuple<>;
+    static constexpr bool has_component = false;
+
+    static sparse_set<T, Bits, Allocator> const& ids(sparse_set<T, Bits, Allocator> const& set) { return set; }
+};
+
+template<typename T, size_t Bits, typename Allocator>
+struct query_source<sparse_set<T, Bits, Allocator> const> : query_source<sparse_set<T, Bits, Allocator>> {};
+
+template<typename Id, typename V, size_t Bits>
+struct query_source<sparse_map<Id, V, Bits>> {
+    using id_type = Id;
+    using components = tuple<V&>;
+    static constexpr bool has_component = true;
+
+    static sparse_set<Id, Bits> const& ids(sparse_map<Id, V, Bits> const& map) { return map.ids(); }
+    static V& value(sparse_map<Id, V, Bits>& map, size_t index) { return map.values()[index]; }
+};
+
+template<typename Id, typename V, size_t Bits>
+struct query_source<sparse_map<Id, V, Bits> const> {
+    using id_type = Id;
+    using components = tuple<V const&>;
+    static constexpr bool has_component = true;
+
+    static sparse_set<Id, Bits> const& ids(sparse_map<Id, V, Bits> const& map) { return map.ids(); }
+    static V const& value(sparse_map<Id, V, Bits> const& map, size_t index) { return map.values()[index]; }
+};
+
+// Positions I of the sources for which Keep is true, as an index_sequence
+template<size_t I, typename Out, bool... Keep>
+struct component_indices;
+
+template<size_t I, size_t... Out>
+struct component_indices<I, index_sequence<Out...>> {
+    using type = index_sequence<Out...>;
+};
+
+template<size_t I, size_t... Out, bool Head, bool... Tail>
+struct component_indices<I, index_sequence<Out...>, Head, Tail...> :
+    component_indices<I + 1, conditional_t<Head, index_sequence<Out..., I>, index_sequence<Out...>>, Tail...> {};
+
+template<typename... Tuples>
+struct tuple_concat;
+
+template<typename... Ts>
+struct tuple_concat<tuple<Ts...>> {
+    using type = tuple<Ts...>;
+};
+
+template<typename... Ts, typename... Us, typename... Rest>
+struct tuple_concat<tuple<Ts...>, tuple<Us...>, Rest...> : tuple_concat<tuple<Ts..., Us...>, Rest...> {};
+
+} // namespace detail
+
+// Iterates over the ids that are in every one of Sources, which are sparse_sets and sparse_maps with the
+// same id type. Dereferencing gives a tuple of the id followed by a reference to the value of that id in
+// every sparse_map, in the order the sources were given:
+//     for (auto [entity, position, velocity] : stl::query(alive, positions, velocities)) { ... }
+// Iteration runs over the dense ids of the smallest source, and every other source is probed with a single
+// reverse lookup per id. Sources must not be modified while a query over them is iterated.
+template<typename... Sources>
+class query_view {
+    static_assert(sizeof...(Sources) > 0, "query_view needs at least one source");
+public:
+    using id_type = typename detail::query_source<typename pack_element<0, Sources...>::type>::id_type;
+    static_assert((std::is_same_v<typename detail::query_source<Sources>::id_type, id_type> && ...),
+        "all sources of a query must have the same id type");
+
+    using reference = typename detail::tuple_concat<tuple<id_type>, typename detail::query_source<Sources>::components...>::type;
+
+    class iterator {
+    public:
+        iterator(query_view const* view, size_t index) : _view(view), _index(index) {
+            advance();
+        }
+
+        reference operator*() const {
+            return _view->row(_index, _indices, components{});
+        }
+
+        iterator& operator++() { ++_index; advance(); return *this; }
+        iterator operator++(int) { iterator old = *this; ++*this; return old; }
+
+        bool operator==(iterator const& rhs) const { return _index == rhs._index; }
+        bool operator!=(iterator const& rhs) const { return _index != rhs._index; }
+
+    private:
+        query_view const* _view;
+        // Index in the dense ids of the smallest source
+        size_t _index;
+        // Index of the current id in every source, filled in by advance()
+        size_t _indices[sizeof...(Sources)] = {};
+
+        // Skips ids that are missing from any source
+        void advance() {
+            while (_index < _view->_driver_size && !_view->probe(_index, _indices, indices{})) {
+                ++_index;
+            }
+        }
+    };
+
+    explicit query_view(Sources&... sources);
+
+    iterator begin() const;
+    iterator end() const;
+
+    // Upper bound on the amount of ids in the query, the size of its smallest source
+    size_t size_hint() const;
+
+private:
+    using indices = make_index_sequence<sizeof...(Sources)>;
+    // Positions of the sources that contribute a value to reference
+    using components = typename detail::component_indices<0, index_sequence<>,
+        detail::query_source<Sources>::has_component...>::type;
+
+    tuple<Sources*...> _sources;
+    // Dense ids of the smallest source, which drives iteration
+    id_type const* _driver;
+    size_t _driver_size;
+    size_t _driver_source;
+
+    // Looks up the id at index i of the driver in every source. Returns false if any of them lacks it
+    template<size_t... Is>
+    bool probe(size_t i, size_t* out, index_sequence<Is...>) const;
+
+    template<size_t... Is>
+    reference row(size_t i, size_t const* in, index_sequence<Is...>) const;
+};
+
+template<typename... Sources>
+query_view<Sources...> query(Sources&... sources) {
+    return query_view<Sources...>(sources ...);
+}
+
+template<typename... Sources>
+query_view<Sources...>::query_view(Sources&... sources) : _sources(&sources ...), _driver(nullptr),
+    _driver_size(size_t(-1)), _driver_source(0) {
+
+    size_t source = 0;
+    auto pick = [this, &source](auto const& ids) {
+        if (ids.size() < _driver_size) {
+            _driver = ids.data();
+            _driver_size = ids.size();
+            _driver_source = source;
+        }
+        ++source;
+    };
+    (pick(detail::query_source<Sources>::ids(sources)), ...);
+}
+
+template<typename... Sources>
+typename query_view<Sources...>::iterator query_view<Sources...>::begin() const {
+    return iterator(this, 0);
+}
+
+template<typename... Sources>
+typename query_view<Sources...>::iterator query_view<Sources...>::end() const {
+    return iterator(this, _driver_size);
+}
+
+template<typename... Sources>
+size_t query_view<Sources...>::size_hint() const {
+    return _driver_size;
+}
+
+template<typename... Sources>
+template<size_t... Is>
+bool query_view<Sources...>::probe(size_t i, size_t* out, index_sequence<Is...>) const {
+    id_type const id = _driver[i];
+    auto lookup = [this, i, id, out](auto const& ids, size_t source) {
+        // The id is known to be at index i of the driver, no need to look it up
+        if (source == _driver_source) {
+            out[source] = i;
+            return true;
+        }
+        out[source] = ids.find(id).get_index();
+        return out[source] < ids.size();
+    };
+    return (lookup(detail::query_source<Sources>::ids(*stl::get<Is>(_sources)), Is) && ...);
+}
+
+template<typename... Sources>
+template<size_t... Is>
+typename query_view<Sources...>::reference query_view<Sources...>::row(size_t i, size_t const* in, index_sequence<Is...>) const {
+    return reference(_driver[i],
+        detail::query_source<typename pack_element<Is, Sources...>::type>::value(*stl::get<Is>(_sources), in[Is]) ...);
+}
+
+} // namespace stl
+
+#endif
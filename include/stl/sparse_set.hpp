@@ -5,23 +5,75 @@
 #include <stl/traits.hpp>
 #include <stl/assert.hpp>
 
+#include <cstring>
+
 namespace stl {
 
-template<typename T>
+template<typename Id, typename V, size_t IndexBits>
+class sparse_map;
+
+// Set of unsigned integers with O(1) insert and lookup and contiguous iteration. The values are stored
+// packed in the direct array. The reverse array maps a value to its index in the direct array. It is split
+// into pages of page_size entries that are only allocated once a value in their range is inserted, so
+// memory use follows the values actually stored instead of the largest one. A flat table of page pointers
+// keeps lookups at a single extra indirection. It costs 8 bytes per page_size indices up to the largest
+// index, 8 MB for an index near 2^32. Pages and the table are allocated from Allocator.
+// With IndexBits smaller than the width of T, values are versioned handles: the low IndexBits bits are
+// the index used for the reverse array and the remaining bits a generation counter. Only one generation
+// of an index can be in the set at a time, and find() rejects handles of any other generation, so
+// indices can be recycled (see next_generation()) without stale handles finding the new value.
+template<typename T, size_t IndexBits = sizeof(T) * 8, typename Allocator = stl::allocator>
 class sparse_set {
 public:
     // Requirements
     static_assert(is_unsigned_v<T>, "sparse_set value type must be an unsigned integral type");
+    static_assert(IndexBits > 0 && IndexBits <= sizeof(T) * 8, "invalid amount of index bits");
 
     // Typedefs
     using value_type = T;
+
+    // Entries per page of the reverse array
+    static constexpr size_t page_size = 4096;
+
+    static constexpr size_t index_bits = IndexBits;
+    static constexpr bool versioned = IndexBits < sizeof(T) * 8;
+    static constexpr T index_mask = versioned ? T((T(1) << (IndexBits % (sizeof(T) * 8))) - 1) : T(~T(0));
+
+    // Index part of a value
+    static constexpr T index_of(T value) {
+        return value & index_mask;
+    }
+
+    // Generation part of a value, always zero if the set is not versioned
+    static constexpr T generation_of(T value) {
+        if constexpr (versioned) {
+            return value >> IndexBits;
+        } else {
+            return 0;
+        }
+    }
+
+    static constexpr T make_handle(T index, T generation) {
+        STL_ASSERT(index <= index_mask, "index does not fit in the index bits");
+        if constexpr (versioned) {
+            return T(generation << IndexBits) | index;
+        } else {
+            return index;
+        }
+    }
+
+    // Same index with the generation incremented, wrapping around on overflow. Used to recycle the index
+    // of an erased handle.
+    static constexpr T next_generation(T value) {
+        return make_handle(index_of(value), generation_of(value) + 1);
+    }
     
     // Note that the iterator is always const, since the values are always returned by value.
     class iterator {
     public:
         using value_type = T;
 
-        iterator(vector<T> const* direct_ref, size_t index) :
+        iterator(vector<T, Allocator> const* direct_ref, size_t index) :
             direct_ref(direct_ref), index(index) {
         }
 
@@ -34,7 +86,7 @@ public:
             return *this;
         }
 
-        iterator& operator++(int) {
+        iterator operator++(int) {
             iterator old = *this;
             ++index;
             return old;
@@ -45,10 +97,10 @@ public:
             return *this;
         }
 
-        iterator& operator--(int) {
+        iterator operator--(int) {
             iterator old = *this;
             --index;
-            return *this;
+            return old;
         }
 
         bool operator==(iterator other) const {
@@ -94,18 +146,65 @@ public:
     private:
         friend class sparse_set;
 
-        vector<T> const* direct_ref;
+        vector<T, Allocator> const* direct_ref;
         size_t index;
     };
 
     sparse_set() = default;
-    sparse_set(sparse_set const& rhs) = default;
-    sparse_set(sparse_set&& rhs) = default;
 
-    sparse_set& operator=(sparse_set const& rhs) = default;
-    sparse_set& operator=(sparse_set&& rhs) = default;
+    // Creates an empty set that allocates from allocator
+    explicit sparse_set(Allocator allocator) : direct(allocator), pages(stl::move(allocator)) {
+
+    }
 
-    ~sparse_set() = default;
+    sparse_set(sparse_set const& rhs) : direct(rhs.direct),
+        pages(allocator_traits<Allocator>::select_on_copy_construction(rhs.pages.get_allocator())) {
+        copy_pages(rhs);
+    }
+
+    sparse_set(sparse_set&& rhs) : direct(stl::move(rhs.direct)), pages(take_pages(rhs)) {
+        if constexpr (!allocator_traits<Allocator>::buffer_survives_move) {
+            // The pages of rhs live inside its allocator, so we need our own
+            copy_pages(rhs);
+            rhs.release_pages();
+        }
+    }
+
+    sparse_set& operator=(sparse_set const& rhs) {
+        if (this == &rhs) return *this;
+
+        release_pages();
+        if constexpr (allocator_traits<Allocator>::propagate_on_copy_assignment) {
+            // Copying the table adopts the allocator of rhs. Its page pointers are not ours, so drop them
+            pages = rhs.pages;
+            pages.clear();
+        }
+        direct = rhs.direct;
+        copy_pages(rhs);
+        return *this;
+    }
+
+    sparse_set& operator=(sparse_set&& rhs) {
+        if (this == &rhs) return *this;
+
+        release_pages();
+        direct = stl::move(rhs.direct);
+        if constexpr (!allocator_traits<Allocator>::propagate_on_move_assignment) {
+            // We cannot take over pages from an allocator we do not share, copy them instead
+            if (!allocator_traits<Allocator>::equal(pages.get_allocator(), rhs.pages.get_allocator())) {
+                copy_pages(rhs);
+                rhs.release_pages();
+                return *this;
+            }
+        }
+
+        pages = stl::move(rhs.pages);
+        return *this;
+    }
+
+    ~sparse_set() {
+        release_pages();
+    }
 
     iterator begin() const {
         return iterator(&direct, 0);
@@ -116,13 +215,14 @@ public:
     }
 
     iterator find(T value) const {
-        // If the value cannot fit in our reverse vector, it certainly isn't in the set
-        if (value >= reverse.size()) return end();
-        // If a value is in the set, the direct and reverse values point at each other
-        T index = reverse[value];
-        T direct_val = direct[index];
-
-        if (direct_val == value) {
+        T const* entry = reverse_entry(index_of(value));
+        // If the page for this value was never allocated, it certainly isn't in the set
+        if (!entry) return end();
+        // If a value is in the set, the direct and reverse values point at each other. Comparing the whole
+        // value also rejects handles with a different generation.
+        size_t index = *entry;
+
+        if (index < direct.size() && direct[index] == value) {
             return iterator(&direct, index);
         }
 
@@ -132,20 +232,52 @@ public:
     // Returns an iterator pointing to the inserted value
     iterator insert(T value) {
         STL_ASSERT(find(value) == end(), "sparse_set cannot have duplicate values.");
+        STL_ASSERT(!contains_index(index_of(value)), "sparse_set already holds another generation of this index.");
 
         size_t index = direct.size();
 
+        // Make sure the page holding the reverse entry for value exists. This comes first, so running out of
+        // memory leaves no value in the direct array without a reverse entry.
+        assure_page(index_of(value));
         direct.push_back(value);
-
-        // Make sure the reverse vector can hold at least enough values to make index value valid.
-        assure_capacity(value + 1);
-        reverse[value] = index;
+        set_reverse(value, index);
 
         return iterator(&direct, index);
     }
 
+    // Erases value by moving the last value into its slot. Returns whether value was in the set
+    bool erase(T value) {
+        iterator it = find(value);
+        if (it == end()) return false;
+
+        erase_at(it.get_index());
+        return true;
+    }
+
+    // Erases the values in [first, last). Values after the range may be moved into it, so the order of
+    // values is not kept. Returns an iterator to the slot of the first erased value.
+    iterator erase(iterator first, iterator last) {
+        STL_ASSERT(first <= last && last <= end(), "invalid range given to sparse_set::erase()");
+
+        // Back to front, so every slot in the range is only filled once with a value from behind the range
+        for (size_t i = last.get_index(); i > first.get_index(); --i) {
+            erase_at(i - 1);
+        }
+
+        return iterator(&direct, first.get_index());
+    }
+
+    // Erases all values for which pred returns true, in a single pass that keeps the order of the
+    // remaining values. Returns the amount of erased values.
+    template<typename Pred>
+    size_t remove_if(Pred pred) {
+        return compact([this, &pred](size_t i) { return pred(direct[i]); }, [](size_t, size_t) {});
+    }
+
+    // Removes all values and frees the reverse array
     void clear() {
-        reverse.clear();
+        release_pages();
+        pages.shrink_to_fit();
         direct.clear();
     }
 
@@ -153,15 +285,139 @@ public:
         return direct.size();
     }
 
+    // The direct array, in iteration order
+    T const* data() const {
+        return direct.data();
+    }
+
+    // Whether a value with this index, of any generation, is in the set
+    bool contains_index(T index) const {
+        T const* entry = reverse_entry(index);
+        return entry && *entry < direct.size() && index_of(direct[*entry]) == index;
+    }
+
 private:
-    void assure_capacity(T n) {
-        if (reverse.size() < n) {
-            reverse.resize(n);
+    template<typename Id, typename V, size_t Bits>
+    friend class sparse_map;
+
+    // Swap-and-pop of the value at index in the direct array
+    void erase_at(size_t index) {
+        T const last = direct.back();
+        direct[index] = last;
+        set_reverse(last, index);
+        direct.pop_back();
+    }
+
+    // Removes values for which pred(index) returns true by moving kept values forward. on_move(from, to) is
+    // called for every value that changes index, before the value itself moves, so containers built on top
+    // can keep parallel arrays in sync. on_move must not throw. If pred throws, the values it was not called
+    // for yet are kept and the set stays consistent.
+    template<typename Pred, typename F>
+    size_t compact(Pred&& pred, F&& on_move) {
+        size_t const old_size = direct.size();
+        size_t out = 0;
+        size_t i = 0;
+        try {
+            for (; i < old_size; ++i) {
+                if (pred(i)) continue;
+                move_slot(i, out++, on_move);
+            }
+        } catch (...) {
+            // Close the gap left by the erased values before passing the exception on
+            for (; i < old_size; ++i) {
+                move_slot(i, out++, on_move);
+            }
+            direct.erase(direct.begin() + out, direct.end());
+            throw;
+        }
+
+        direct.erase(direct.begin() + out, direct.end());
+        return old_size - out;
+    }
+
+    // Moves the value at index from to index to <= from as part of compact()
+    template<typename F>
+    void move_slot(size_t from, size_t to, F& on_move) {
+        if (from == to) return;
+
+        on_move(from, to);
+        T const value = direct[from];
+        direct[to] = value;
+        set_reverse(value, to);
+    }
+
+    // Returns the reverse entry for index, or nullptr if its page does not exist
+    T const* reverse_entry(T index) const {
+        size_t const page = size_t(index) / page_size;
+        if (page >= pages.size() || !pages[page]) return nullptr;
+        return pages[page] + size_t(index) % page_size;
+    }
+
+    // Points the reverse entry of value at its slot in the direct array. The page must exist
+    void set_reverse(T value, size_t slot) {
+        size_t const index = index_of(value);
+        pages[index / page_size][index % page_size] = slot;
+    }
+
+    void assure_page(T index) {
+        size_t const page = size_t(index) / page_size;
+        if (pages.size() <= page) {
+            // Grow the table geometrically, resize() alone would reallocate it for every new page
+            pages.reserve(stl::max(page + 1, pages.size() * 2));
+            pages.resize(page + 1);
+        }
+
+        if (!pages[page]) {
+            pages[page] = allocate_page();
+        }
+    }
+
+    T* allocate_page() {
+        T* entries = static_cast<T*>(pages.get_allocator().allocate(page_size * sizeof(T)));
+        std::memset(entries, 0, page_size * sizeof(T));
+        return entries;
+    }
+
+    // Copies the pages of rhs into an empty table. If an allocation throws, the set is left empty
+    void copy_pages(sparse_set const& rhs) {
+        try {
+            pages.resize(rhs.pages.size());
+            for (size_t page = 0; page < rhs.pages.size(); ++page) {
+                if (!rhs.pages[page]) continue;
+
+                pages[page] = static_cast<T*>(pages.get_allocator().allocate(page_size * sizeof(T)));
+                std::memcpy(pages[page], rhs.pages[page], page_size * sizeof(T));
+            }
+        } catch (...) {
+            release_pages();
+            direct.clear();
+            throw;
+        }
+    }
+
+    // Frees all pages
+    void release_pages() {
+        for (T* entries : pages) {
+            if (entries) {
+                pages.get_allocator().deallocate(entries, page_size * sizeof(T));
+            }
+        }
+        pages.clear();
+    }
+
+    // Page table for a set move constructed from rhs. It only takes over the pages of rhs if they stay valid
+    // after the move.
+    static vector<T*, Allocator> take_pages(sparse_set& rhs) {
+        if constexpr (allocator_traits<Allocator>::buffer_survives_move) {
+            return stl::move(rhs.pages);
+        } else {
+            return vector<T*, Allocator>(stl::move(rhs.pages.get_allocator()));
         }
     }
 
-    vector<T> direct;
-    vector<T> reverse;
+    vector<T, Allocator> direct;
+    // Pages of the reverse array, null for pages that were never needed
+    vector<T*, Allocator> pages;
 };
 
 } // namespace stl
@@ -0,0 +1,355 @@
+#ifndef STL_STATIC_VECTOR_HPP_
+#define STL_STATIC_VECTOR_HPP_
+
+#include <stl/tags.hpp>
+#include <stl/memory.hpp>
+#include <stl/utility.hpp>
+#include <stl/algorithm.hpp>
+#include <stl/assert.hpp>
+#include <stl/exception.hpp>
+
+namespace stl {
+
+// Vector with a fixed capacity of N elements, stored inside the object. It never allocates.
+// Exceeding the capacity is a bug, checked with STL_ASSERT in debug builds only.
+template<typename T, stl::size_t N>
+class static_vector {
+    static_assert(N > 0, "static_vector needs a capacity of at least one element");
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = T const*;
+
+    static_vector() = default;
+    // Fills the vector with n default constructed items
+    explicit static_vector(stl::size_t n);
+    // Fills the vector with n uninitialized items
+    static_vector(stl::tags::uninitialized_tag, stl::size_t n);
+    // Fills the vector with n copies of initial_value
+    static_vector(stl::size_t n, T const& initial_value);
+
+    template<typename InputIt>
+    static_vector(stl::tags::range_construct_tag, InputIt first, InputIt last);
+
+    static_vector(static_vector const& other);
+    static_vector(static_vector&& other);
+
+    static_vector& operator=(static_vector const& other);
+    static_vector& operator=(static_vector&& other);
+
+    ~static_vector();
+
+    T* data();
+    T const* data() const;
+
+    stl::size_t size() const;
+    static constexpr stl::size_t capacity() { return N; }
+
+    bool empty() const;
+    bool full() const;
+
+    iterator begin();
+    const_iterator begin() const;
+
+    iterator end();
+    const_iterator end() const;
+
+    T& operator[](stl::size_t i);
+    T const& operator[](stl::size_t i) const;
+
+    T& at(stl::size_t i);
+    T const& at(stl::size_t i) const;
+
+    T& front();
+    T const& front() const;
+
+    T& back();
+    T const& back() const;
+
+    // Does not allocate, only checks that n elements fit
+    void reserve(stl::size_t n);
+    // Resizes the vector and adds default constructed elements to the end
+    void resize(stl::size_t n);
+    // Resizes the vector and adds uninitialized elements at the end
+    void resize(stl::tags::uninitialized_tag, stl::size_t n);
+
+    void push_back(T const& value);
+    void push_back(T&& value);
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+
+    void pop_back();
+
+    void clear();
+
+    void swap(static_vector& other);
+
+    // Inserts value before pos. Returns the iterator pointing to the inserted value
+    iterator insert(iterator pos, T const& value);
+    iterator insert(iterator pos, T&& value);
+
+    // Erases the value at iterator pos. Returns the iterator pointing to the value next to it.
+    iterator erase(iterator pos);
+
+private:
+    alignas(T) unsigned char _storage[N * sizeof(T)];
+    stl::size_t _size = 0;
+};
+
+template<typename T, stl::size_t N>
+static_vector<T, N>::static_vector(stl::size_t n) : static_vector(stl::tags::uninitialized, n) {
+    inplace_construct_n(data(), n);
+}
+
+template<typename T, stl::size_t N>
+static_vector<T, N>::static_vector(stl::tags::uninitialized_tag, stl::size_t n) {
+    STL_ASSERT(n <= N, "static_vector capacity exceeded");
+    _size = n;
+}
+
+template<typename T, stl::size_t N>
+static_vector<T, N>::static_vector(stl::size_t n, T const& initial_value) : static_vector(stl::tags::uninitialized, n) {
+    inplace_construct_n(data(), n, initial_value);
+}
+
+template<typename T, stl::size_t N>
+template<typename InputIt>
+static_vector<T, N>::static_vector(stl::tags::range_construct_tag, InputIt first, InputIt last) :
+    static_vector(stl::tags::uninitialized, stl::abs_distance(first, last)) {
+    inplace_construct_from_range(data(), first, last);
+}
+
+template<typename T, stl::size_t N>
+static_vector<T, N>::static_vector(static_vector const& other) : _size(other._size) {
+    inplace_construct_from_range(data(), other.begin(), other.end());
+}
+
+template<typename T, stl::size_t N>
+static_vector<T, N>::static_vector(static_vector&& other) : _size(other._size) {
+    // The elements live inside the object, so they can only be moved one by one
+    inplace_move_from_range(data(), other.begin(), other.end());
+    other.clear();
+}
+
+template<typename T, stl::size_t N>
+static_vector<T, N>& static_vector<T, N>::operator=(static_vector const& other) {
+    if (this == &other) return *this;
+
+    clear();
+    inplace_construct_from_range(data(), other.begin(), other.end());
+    _size = other._size;
+
+    return *this;
+}
+
+template<typename T, stl::size_t N>
+static_vector<T, N>& static_vector<T, N>::operator=(static_vector&& other) {
+    if (this == &other) return *this;
+
+    clear();
+    inplace_move_from_range(data(), other.begin(), other.end());
+    _size = other._size;
+    other.clear();
+
+    return *this;
+}
+
+template<typename T, stl::size_t N>
+static_vector<T, N>::~static_vector() {
+    destruct_n(data(), _size);
+}
+
+template<typename T, stl::size_t N>
+T* static_vector<T, N>::data() {
+    return reinterpret_cast<T*>(_storage);
+}
+
+template<typename T, stl::size_t N>
+T const* static_vector<T, N>::data() const {
+    return reinterpret_cast<T const*>(_storage);
+}
+
+template<typename T, stl::size_t N>
+stl::size_t static_vector<T, N>::size() const {
+    return _size;
+}
+
+template<typename T, stl::size_t N>
+bool static_vector<T, N>::empty() const {
+    return _size == 0;
+}
+
+template<typename T, stl::size_t N>
+bool static_vector<T, N>::full() const {
+    return _size == N;
+}
+
+template<typename T, stl::size_t N>
+typename static_vector<T, N>::iterator static_vector<T, N>::begin() {
+    return data();
+}
+
+template<typename T, stl::size_t N>
+typename static_vector<T, N>::const_iterator static_vector<T, N>::begin() const {
+    return data();
+}
+
+template<typename T, stl::size_t N>
+typename static_vector<T, N>::iterator static_vector<T, N>::end() {
+    return data() + _size;
+}
+
+template<typename T, stl::size_t N>
+typename static_vector<T, N>::const_iterator static_vector<T, N>::end() const {
+    return data() + _size;
+}
+
+template<typename T, stl::size_t N>
+T& static_vector<T, N>::operator[](stl::size_t i) {
+    STL_ASSERT(i < _size, "static_vector index out of range");
+    return data()[i];
+}
+
+template<typename T, stl::size_t N>
+T const& static_vector<T, N>::operator[](stl::size_t i) const {
+    STL_ASSERT(i < _size, "static_vector index out of range");
+    return data()[i];
+}
+
+template<typename T, stl::size_t N>
+T& static_vector<T, N>::at(stl::size_t i) {
+    if (i >= _size) throw std::out_of_range("static_vector index out of range");
+    return data()[i];
+}
+
+template<typename T, stl::size_t N>
+T const& static_vector<T, N>::at(stl::size_t i) const {
+    if (i >= _size) throw std::out_of_range("static_vector index out of range");
+    return data()[i];
+}
+
+template<typename T, stl::size_t N>
+T& static_vector<T, N>::front() {
+    STL_ASSERT(!empty(), "front() called on empty static_vector");
+    return data()[0];
+}
+
+template<typename T, stl::size_t N>
+T const& static_vector<T, N>::front() const {
+    STL_ASSERT(!empty(), "front() called on empty static_vector");
+    return data()[0];
+}
+
+template<typename T, stl::size_t N>
+T& static_vector<T, N>::back() {
+    STL_ASSERT(!empty(), "back() called on empty static_vector");
+    return data()[_size - 1];
+}
+
+template<typename T, stl::size_t N>
+T const& static_vector<T, N>::back() const {
+    STL_ASSERT(!empty(), "back() called on empty static_vector");
+    return data()[_size - 1];
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::reserve([[maybe_unused]] stl::size_t n) {
+    STL_ASSERT(n <= N, "static_vector capacity exceeded");
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::resize(stl::size_t n) {
+    if (_size >= n) { return; }
+
+    STL_ASSERT(n <= N, "static_vector capacity exceeded");
+    inplace_construct_n(end(), n - _size);
+    _size = n;
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::resize(stl::tags::uninitialized_tag, stl::size_t n) {
+    if (_size >= n) { return; }
+
+    STL_ASSERT(n <= N, "static_vector capacity exceeded");
+    _size = n;
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::push_back(T const& value) {
+    STL_ASSERT(_size < N, "static_vector capacity exceeded");
+    new (end()) T { value };
+    _size += 1;
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::push_back(T&& value) {
+    STL_ASSERT(_size < N, "static_vector capacity exceeded");
+    new (end()) T { stl::move(value) };
+    _size += 1;
+}
+
+template<typename T, stl::size_t N>
+template<typename... Args>
+T& static_vector<T, N>::emplace_back(Args&&... args) {
+    STL_ASSERT(_size < N, "static_vector capacity exceeded");
+    new (end()) T { stl::forward<Args>(args) ... };
+    _size += 1;
+
+    return back();
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::pop_back() {
+    STL_ASSERT(!empty(), "pop_back() called on empty static_vector");
+    destruct_n(end() - 1, 1);
+    _size -= 1;
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::clear() {
+    destruct_n(data(), _size);
+    _size = 0;
+}
+
+template<typename T, stl::size_t N>
+void static_vector<T, N>::swap(static_vector& other) {
+    static_vector tmp = stl::move(other);
+    other = stl::move(*this);
+    *this = stl::move(tmp);
+}
+
+template<typename T, stl::size_t N>
+typename static_vector<T, N>::iterator static_vector<T, N>::insert(iterator pos, T const& value) {
+    // Copying first keeps value valid if it lives in this vector
+    T cpy = value;
+    return insert(pos, stl::move(cpy));
+}
+
+template<typename T, stl::size_t N>
+typename static_vector<T, N>::iterator static_vector<T, N>::insert(iterator pos, T&& value) {
+    STL_ASSERT(pos >= begin() && pos <= end(), "invalid iterator given to static_vector::insert()");
+    STL_ASSERT(_size < N, "static_vector capacity exceeded");
+
+    // Shift the tail back by one to open up a slot at pos
+    relocate_overlapping_n(pos + 1, pos, end() - pos);
+    new (pos) T { stl::move(value) };
+    _size += 1;
+
+    return pos;
+}
+
+template<typename T, stl::size_t N>
+typename static_vector<T, N>::iterator static_vector<T, N>::erase(iterator pos) {
+    STL_ASSERT(pos >= begin() && pos < end(), "invalid iterator given to static_vector::erase()");
+
+    destruct_n(pos, 1);
+    relocate_overlapping_n(pos, pos + 1, end() - pos - 1);
+    _size -= 1;
+
+    return pos;
+}
+
+} // namespace stl
+
+#endif
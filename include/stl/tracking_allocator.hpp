@@ -0,0 +1,166 @@
+#ifndef STL_TRACKING_ALLOCATOR_HPP_
+#define STL_TRACKING_ALLOCATOR_HPP_
+
+#include <stl/allocator.hpp>
+
+#include <atomic>
+
+namespace stl {
+
+// Copy of the state of allocation_counters at one point in time
+struct allocation_stats {
+    // Bucket i counts allocations of [2^i, 2^(i + 1)) bytes. The last bucket also holds everything larger.
+    static constexpr stl::size_t histogram_buckets = 32;
+
+    stl::size_t live_bytes = 0;
+    stl::size_t peak_bytes = 0;
+    stl::size_t allocation_count = 0;
+    stl::size_t deallocation_count = 0;
+    stl::size_t reallocation_count = 0;
+    stl::size_t total_allocated_bytes = 0;
+    stl::size_t size_histogram[histogram_buckets] = {};
+};
+
+// Allocation statistics that can be updated from any thread. All counters are relaxed atomics,
+// so they are cheap enough to leave on in release builds.
+class allocation_counters {
+public:
+    allocation_counters() = default;
+
+    allocation_counters(allocation_counters const&) = delete;
+    allocation_counters& operator=(allocation_counters const&) = delete;
+
+    void record_allocate(stl::size_t size);
+    void record_deallocate(stl::size_t size);
+    // A block was resized from old_size to new_size, either in place or by moving it
+    void record_reallocate(stl::size_t old_size, stl::size_t new_size);
+    // Records a reallocate(ptr, old_size, new_size) call that returned new_ptr. Reallocating nullptr counts as
+    // an allocation and a result of nullptr as a deallocation, so allocations and deallocations stay balanced.
+    void record_reallocate_result(void const* ptr, stl::size_t old_size, void const* new_ptr, stl::size_t new_size);
+
+    allocation_stats snapshot() const;
+    void reset();
+
+private:
+    std::atomic<stl::size_t> _live_bytes { 0 };
+    std::atomic<stl::size_t> _peak_bytes { 0 };
+    std::atomic<stl::size_t> _allocation_count { 0 };
+    std::atomic<stl::size_t> _deallocation_count { 0 };
+    std::atomic<stl::size_t> _reallocation_count { 0 };
+    std::atomic<stl::size_t> _total_allocated_bytes { 0 };
+    std::atomic<stl::size_t> _size_histogram[allocation_stats::histogram_buckets] = {};
+
+    void add_live_bytes(stl::size_t size);
+};
+
+// Decorator that forwards to a parent allocator and records every allocation made through it.
+// Usually combined with allocator_ref so several containers report into the same counters.
+class tracking_allocator : public allocator_base {
+public:
+    tracking_allocator();
+    explicit tracking_allocator(allocator_base& parent);
+
+    virtual ~tracking_allocator() = default;
+
+    void* allocate(stl::size_t size) override;
+    void deallocate(void* ptr, stl::size_t size) override;
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) override;
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) override;
+
+    bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) override;
+    void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) override;
+
+    stl::size_t good_size(stl::size_t size) const override;
+
+    allocation_counters& counters();
+    allocation_stats snapshot() const;
+
+private:
+    allocator_base* _parent;
+    allocation_counters _counters;
+};
+
+// Named set of counters, linked into a process wide list so all tags can be exported together
+struct allocation_tag {
+    char const* name = nullptr;
+    allocation_counters counters;
+    allocation_tag* next = nullptr;
+
+    explicit allocation_tag(char const* name);
+};
+
+// Returns the most recently registered tag. Follow next to visit the others
+allocation_tag const* allocation_tags();
+
+// Stateless allocator that forwards to Parent and records into counters shared by everything using the same Tag.
+// Tag must have a static name member, for example
+//     struct mesh_tag { static constexpr char const* name = "mesh"; };
+//     stl::vector<vertex, stl::tagged_allocator<mesh_tag>> vertices;
+template<typename Tag, typename Parent = stl::allocator>
+class tagged_allocator : public allocator_base {
+public:
+    virtual ~tagged_allocator() = default;
+
+    void* allocate(stl::size_t size) override {
+        void* ptr = _parent.allocate(size);
+        if (ptr) {
+            counters().record_allocate(size);
+        }
+        return ptr;
+    }
+
+    void deallocate(void* ptr, stl::size_t size) override {
+        if (ptr == nullptr) { return; }
+        counters().record_deallocate(size);
+        _parent.deallocate(ptr, size);
+    }
+
+    void* allocate_aligned(stl::size_t size, stl::size_t alignment) override {
+        void* ptr = _parent.allocate_aligned(size, alignment);
+        if (ptr) {
+            counters().record_allocate(size);
+        }
+        return ptr;
+    }
+
+    void deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) override {
+        if (ptr == nullptr) { return; }
+        counters().record_deallocate(size);
+        _parent.deallocate_aligned(ptr, size, alignment);
+    }
+
+    bool try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) override {
+        if (!_parent.try_expand(ptr, old_size, new_size)) {
+            return false;
+        }
+        counters().record_reallocate(old_size, new_size);
+        return true;
+    }
+
+    void* reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) override {
+        void* new_ptr = _parent.reallocate(ptr, old_size, new_size);
+        counters().record_reallocate_result(ptr, old_size, new_ptr, new_size);
+        return new_ptr;
+    }
+
+    stl::size_t good_size(stl::size_t size) const override {
+        return _parent.good_size(size);
+    }
+
+    static allocation_counters& counters() {
+        static allocation_tag tag(Tag::name);
+        return tag.counters;
+    }
+
+    static allocation_stats snapshot() {
+        return counters().snapshot();
+    }
+
+private:
+    Parent _parent;
+};
+
+}
+
+#endif
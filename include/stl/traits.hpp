@@ -127,6 +127,15 @@ struct conditional<false, T, U> {
 template<bool B, typename T, typename U>
 using conditional_t = typename conditional<B, T, U>::type;
 
+// Types for which moving an object to a new address and destroying the old one is equivalent to copying
+// its bytes. Trivially copyable types are detected automatically, other types can opt in by specializing
+// this trait.
+template<typename T>
+struct is_trivially_relocatable : conditional_t<std::is_trivially_copyable_v<T>, true_type, false_type> {};
+
+template<typename T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
 } // namespace stl
 
 #endif
\ No newline at end of file
@@ -135,6 +135,13 @@ public:
     }
 };
 
+// Structured bindings call get() on an rvalue when the tuple is bound by value
+template<stl::size_t I, typename... Ts>
+typename pack_element<I, Ts...>::type&& get(tuple<Ts...>&& t) {
+    using value_type = typename pack_element<I, Ts...>::type;
+    return static_cast<value_type&&>(t.template _internal_get<I>());
+}
+
 template<typename... Ts>
 tuple<stl::remove_reference_t<Ts>...> make_tuple(Ts&&... values) {
     return tuple<stl::remove_reference_t<Ts>...>(stl::forward<Ts>(values) ...);
@@ -148,7 +155,7 @@ tuple<Ts& ...> tie(Ts& ... values) {
 namespace detail {
 
 template<typename... Ts, typename... Us, stl::size_t... Is1, stl::size_t... Is2>
-tuple<Ts..., Us...> concat_two_tuples_impl(tuple<Ts...> lhs, tuple<Us...> rhs, 
+tuple<Ts..., Us...> concat_two_tuples_impl([[maybe_unused]] tuple<Ts...> lhs, [[maybe_unused]] tuple<Us...> rhs,
     index_sequence<Is1...>, index_sequence<Is2...>) {
 
     return tuple<Ts..., Us...>(get<Is1>(lhs) ..., get<Is2>(rhs) ...);
@@ -17,6 +17,8 @@ using uint32_t = std::uint32_t;
 using uint64_t = std::uint64_t;
 
 using size_t = std::size_t;
+using ptrdiff_t = std::ptrdiff_t;
+using uintptr_t = std::uintptr_t;
 
 } // namespace stl
 
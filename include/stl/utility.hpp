@@ -20,6 +20,13 @@ constexpr T&& move(T& param) {
     return static_cast<T&&>(param);
 }
 
+template<typename T>
+void swap(T& lhs, T& rhs) {
+    T tmp = stl::move(lhs);
+    lhs = stl::move(rhs);
+    rhs = stl::move(tmp);
+}
+
 // pack_element
 
 namespace detail {
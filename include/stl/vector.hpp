@@ -8,10 +8,14 @@
 #include <stl/algorithm.hpp>
 #include <stl/assert.hpp>
 #include <stl/exception.hpp>
+#include <stl/traits.hpp>
+#include <stl/span.hpp>
+#include <stl/growth_policy.hpp>
 
 namespace stl {
 
-template<typename T, typename Allocator = stl::allocator>
+// GrowthPolicy decides how much the capacity grows when the vector runs out of space, see growth_policy.hpp
+template<typename T, typename Allocator = stl::allocator, typename GrowthPolicy = stl::grow_2x>
 class vector {
 public:
     using value_type = T;
@@ -19,6 +23,8 @@ public:
     using const_iterator = T const*;
 
     vector() = default;
+    // Creates an empty vector that allocates from allocator
+    explicit vector(Allocator allocator);
     // Fills the vector with n default constructed items
     explicit vector(stl::size_t n);
     // Reserves space for n elements. Does not set the vector's size
@@ -39,6 +45,9 @@ public:
 
     ~vector();
 
+    Allocator& get_allocator();
+    Allocator const& get_allocator() const;
+
     T* data();
     T const* data() const;
 
@@ -71,24 +80,54 @@ public:
     void reserve(stl::tags::uninitialized_tag, stl::size_t n);
     // Resizes the vector and adds default constructed elements to the end
     void resize(stl::size_t n);
-    // Resizes the vector and adds uninitialized elements at the end
+    // Resizes the vector and adds uninitialized elements at the end. Existing elements are kept
     void resize(stl::tags::uninitialized_tag, stl::size_t n);
 
+    // Grows the vector by n uninitialized elements, keeping existing elements, and returns the new elements
+    // so they can be filled in directly (e.g. by read()). They must be written before they are read.
+    span<T> append_uninitialized(stl::size_t n);
+    // Shrinks the region returned by the last append_uninitialized() call to the first written elements.
+    // The elements past written are dropped without calling their destructors.
+    void commit_uninitialized(span<T> region, stl::size_t written);
+
     void push_back(T const& value);
     void push_back(T&& value);
 
     template<typename... Args>
     T& emplace_back(Args&&... args);
 
+    void pop_back();
+
     void clear();
     void shrink_to_fit();
 
+    // Swaps contents with other. Allocators are swapped as well if allocator_traits says so
+    void swap(vector& other);
+
     // Inserts value before pos. Returns the iterator pointing to the inserted value
     iterator insert(iterator pos, T const& value);
     iterator insert(iterator pos, T&& value);
+    // Inserts n copies of value before pos. Returns the iterator pointing to the first inserted value
+    iterator insert(iterator pos, stl::size_t n, T const& value);
+    // Inserts copies of [first, last) before pos. Returns the iterator pointing to the first inserted value.
+    // The range may not point into this vector.
+    template<typename InputIt, std::enable_if_t<!std::is_integral_v<InputIt>, int> = 0>
+    iterator insert(iterator pos, InputIt first, InputIt last);
+    // Appends copies of [first, last) to the end of the vector
+    template<typename InputIt>
+    void append(InputIt first, InputIt last);
 
     // Erases the value at iterator pos. Returns the iterator pointing to the value next to it.
     iterator erase(iterator pos);
+    // Erases the values in [first, last). Returns the iterator pointing to the value after the erased range
+    iterator erase(iterator first, iterator last);
+    // Erases the value at pos by moving the last value into its place. Does not keep the order of elements.
+    // Returns pos, which now holds the value that used to be last.
+    iterator unordered_erase(iterator pos);
+    // Erases all values for which pred returns true, in a single pass that keeps the order of the remaining
+    // values. Returns the amount of erased values.
+    template<typename Pred>
+    stl::size_t erase_if(Pred pred);
 
 private:
     // Data
@@ -102,45 +141,54 @@ private:
     void deallocate(T* ptr, stl::size_t n);
 
     void reserve_uninitialized(stl::size_t n);
-    stl::size_t calc_grow_size() const;
+    // Capacity to grow to when at least required elements have to fit
+    stl::size_t calc_grow_size(stl::size_t required) const;
     // Grows the vector so it can hold n elements. Moves over old data
     void grow(stl::size_t n);
+    // Opens up n uninitialized slots at index, reallocating at most once and moving the tail once.
+    // Returns a pointer to the first slot. Does not update the size.
+    T* open_gap(stl::size_t index, stl::size_t n);
 };
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(stl::size_t n) : vector(stl::tags::uninitialized, n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(stl::size_t n) : vector(stl::tags::uninitialized, n) {
     // We have filled the vector with uninitialized elements. Now default construct them in-place in the vector
     inplace_construct_n(_data, n);
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(stl::tags::reserve_tag, stl::size_t n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(stl::tags::reserve_tag, stl::size_t n) {
     reserve_uninitialized(n);
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(stl::tags::uninitialized_tag, stl::size_t n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(stl::tags::uninitialized_tag, stl::size_t n) {
     reserve_uninitialized(n);
     _size = n;
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(stl::size_t n, T const& initial_value) : vector(stl::tags::uninitialized, n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(stl::size_t n, T const& initial_value) : vector(stl::tags::uninitialized, n) {
     // The vector is filled with uninitialized data, now fill it with the initial values
     inplace_construct_n(_data, n, initial_value);
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy>
 template<typename InputIt>
-vector<T, Allocator>::vector(stl::tags::range_construct_tag, InputIt first, InputIt last) : 
+vector<T, Allocator, GrowthPolicy>::vector(stl::tags::range_construct_tag, InputIt first, InputIt last) : 
     vector(stl::tags::uninitialized, stl::abs_distance(first, last)) {
     // Memory is reserved, now construct a new range
     inplace_construct_from_range(_data, first, last);
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(vector const& other) {
-    _allocator = other._allocator;
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(Allocator allocator) : _allocator(stl::move(allocator)) {
+
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(vector const& other) :
+    _allocator(allocator_traits<Allocator>::select_on_copy_construction(other._allocator)) {
     // Reserve memory and set correct size
     reserve_uninitialized(other._capacity);
     _size = other._size;
@@ -148,9 +196,17 @@ vector<T, Allocator>::vector(vector const& other) {
     inplace_construct_from_range(_data, other.begin(), other.end());
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::vector(vector&& other) {
-    _allocator = stl::move(other._allocator);
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::vector(vector&& other) : _allocator(stl::move(other._allocator)) {
+    if constexpr (!allocator_traits<Allocator>::buffer_survives_move) {
+        // The other vector's memory lives inside its allocator, so we need our own
+        reserve_uninitialized(other._size);
+        inplace_move_from_range(_data, other.begin(), other.end());
+        _size = other._size;
+        other.clear();
+        return;
+    }
+
     _size = other._size;
     _capacity = other._capacity;
     _data = other._data;
@@ -160,12 +216,21 @@ vector<T, Allocator>::vector(vector&& other) {
     other._data = nullptr;
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(vector const& other) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>& vector<T, Allocator, GrowthPolicy>::operator=(vector const& other) {
     // Self assignment check to avoid trouble
     if (this == &other) return *this;
 
-    _allocator = other._allocator;
+    if constexpr (allocator_traits<Allocator>::propagate_on_copy_assignment) {
+        // Our memory has to be freed by the allocator it came from, before that allocator is replaced
+        destruct_n(_data, _size);
+        deallocate(_data, _capacity);
+        _data = nullptr;
+        _size = 0;
+        _capacity = 0;
+
+        _allocator = other._allocator;
+    }
 
     // If we already have enough memory we do not need to reallocate
     if (_capacity >= other._size) {
@@ -193,11 +258,29 @@ vector<T, Allocator>& vector<T, Allocator>::operator=(vector const& other) {
     return *this;
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>& vector<T, Allocator>::operator=(vector&& other) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>& vector<T, Allocator, GrowthPolicy>::operator=(vector&& other) {
     if (this == &other) return *this;
 
-    _allocator = other._allocator;
+    if constexpr (!allocator_traits<Allocator>::propagate_on_move_assignment) {
+        // We cannot take over memory from an allocator we do not share, move the elements instead
+        if (!allocator_traits<Allocator>::equal(_allocator, other._allocator)) {
+            clear();
+            reserve(other._size);
+            inplace_move_from_range(_data, other.begin(), other.end());
+            _size = other._size;
+            other.clear();
+            return *this;
+        }
+    }
+
+    // Free our own memory before taking over the other vector's memory
+    destruct_n(_data, _size);
+    deallocate(_data, _capacity);
+
+    if constexpr (allocator_traits<Allocator>::propagate_on_move_assignment) {
+        _allocator = stl::move(other._allocator);
+    }
     _size = other._size;
     _capacity = other._capacity;
     _data = other._data;
@@ -209,8 +292,8 @@ vector<T, Allocator>& vector<T, Allocator>::operator=(vector&& other) {
     return *this;
 }
 
-template<typename T, typename Allocator>
-vector<T, Allocator>::~vector() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+vector<T, Allocator, GrowthPolicy>::~vector() {
     // Call destructor for previous elements before freeing memory
     destruct_n(_data, _size);
 
@@ -220,117 +303,119 @@ vector<T, Allocator>::~vector() {
     _data = nullptr;
 }
 
-template<typename T, typename Allocator>
-T* vector<T, Allocator>::data() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+Allocator& vector<T, Allocator, GrowthPolicy>::get_allocator() {
+    return _allocator;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+Allocator const& vector<T, Allocator, GrowthPolicy>::get_allocator() const {
+    return _allocator;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+T* vector<T, Allocator, GrowthPolicy>::data() {
     return _data;
 }
 
-template<typename T, typename Allocator>
-T const* vector<T, Allocator>::data() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T const* vector<T, Allocator, GrowthPolicy>::data() const {
     return _data;
 }
 
-template<typename T, typename Allocator>
-stl::size_t vector<T, Allocator>::size() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+stl::size_t vector<T, Allocator, GrowthPolicy>::size() const {
     return _size;
 }
 
-template<typename T, typename Allocator>
-stl::size_t vector<T, Allocator>::capacity() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+stl::size_t vector<T, Allocator, GrowthPolicy>::capacity() const {
     return _capacity;
 }
 
-template<typename T, typename Allocator>
-bool vector<T, Allocator>::empty() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+bool vector<T, Allocator, GrowthPolicy>::empty() const {
     return _size == 0;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::begin() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::begin() {
     return _data;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_iterator vector<T, Allocator>::begin() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::const_iterator vector<T, Allocator, GrowthPolicy>::begin() const {
     return _data;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::end() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::end() {
     return _data + _size;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::const_iterator vector<T, Allocator>::end() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::const_iterator vector<T, Allocator, GrowthPolicy>::end() const {
     return _data + _size;
 }
 
-template<typename T, typename Allocator>
-T& vector<T, Allocator>::operator[](stl::size_t i) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T& vector<T, Allocator, GrowthPolicy>::operator[](stl::size_t i) {
     STL_ASSERT(i < _size, "vector index out of range");
     return _data[i];
 }
 
-template<typename T, typename Allocator>
-T const& vector<T, Allocator>::operator[](stl::size_t i) const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T const& vector<T, Allocator, GrowthPolicy>::operator[](stl::size_t i) const {
     STL_ASSERT(i < _size, "vector index out of range");
     return _data[i];
 }
 
-template<typename T, typename Allocator>
-T& vector<T, Allocator>::at(stl::size_t i) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T& vector<T, Allocator, GrowthPolicy>::at(stl::size_t i) {
     if (i >= _size) throw std::out_of_range("vector index out of range");
     return _data[i];
 }
 
-template<typename T, typename Allocator>
-T const& vector<T, Allocator>::at(stl::size_t i) const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T const& vector<T, Allocator, GrowthPolicy>::at(stl::size_t i) const {
     if (i >= _size) throw std::out_of_range("vector index out of range");
     return _data[i];
 }
 
-template<typename T, typename Allocator>
-T& vector<T, Allocator>::front() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T& vector<T, Allocator, GrowthPolicy>::front() {
     STL_ASSERT(!empty(), "front() called on empty vector");
     return _data[0];
 }
 
-template<typename T, typename Allocator>
-T const& vector<T, Allocator>::front() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T const& vector<T, Allocator, GrowthPolicy>::front() const {
     STL_ASSERT(!empty(), "front() called on empty vector");
     return _data[0];
 }
 
-template<typename T, typename Allocator>
-T& vector<T, Allocator>::back() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T& vector<T, Allocator, GrowthPolicy>::back() {
     STL_ASSERT(!empty(), "back() called on empty vector");
     return _data[_size - 1];
 }
 
-template<typename T, typename Allocator>
-T const& vector<T, Allocator>::back() const {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T const& vector<T, Allocator, GrowthPolicy>::back() const {
     STL_ASSERT(!empty(), "back() called on empty vector");
     return _data[_size - 1];
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::reserve(stl::size_t n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::reserve(stl::size_t n) {
     // No need to allocate extra space
     if (_capacity >= n) { return; }
 
-    // Allocate new memory
-    T* new_data = allocate(n);
-    // Move over old data
-    inplace_move_from_range(new_data, begin(), end());
-    // Free old memory
-    destruct_n(_data, _size);
-    deallocate(_data, _capacity);
-    _capacity = n;
-    _data = new_data;
+    grow(n);
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::reserve(stl::tags::uninitialized_tag, stl::size_t n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::reserve(stl::tags::uninitialized_tag, stl::size_t n) {
     if (_capacity >= n) { return; }
 
     destruct_n(_data, _size);
@@ -341,8 +426,8 @@ void vector<T, Allocator>::reserve(stl::tags::uninitialized_tag, stl::size_t n)
     _size = 0;
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::resize(stl::size_t n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::resize(stl::size_t n) {
     if (_size >= n) { return; }
 
     reserve(n);
@@ -353,20 +438,39 @@ void vector<T, Allocator>::resize(stl::size_t n) {
     // _capacity is set inside reserve()
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::resize(stl::tags::uninitialized_tag, stl::size_t n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::resize(stl::tags::uninitialized_tag, stl::size_t n) {
     if (_size >= n) { return; }
 
-    reserve(n, stl::tags::uninitialized);
+    reserve(n);
     _size = n;
     // _capacity is set inside reserve()
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::push_back(T const& value) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+span<T> vector<T, Allocator, GrowthPolicy>::append_uninitialized(stl::size_t n) {
+    if (_size + n > _capacity) {
+        grow(calc_grow_size(_size + n));
+    }
+
+    T* first = _data + _size;
+    _size += n;
+    return span<T>(first, n);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::commit_uninitialized(span<T> region, stl::size_t written) {
+    STL_ASSERT(region.end() == end(), "region given to commit_uninitialized() is not at the end of the vector");
+    STL_ASSERT(written <= region.size(), "more elements written than appended");
+
+    _size -= region.size() - written;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::push_back(T const& value) {
     // If we have reached the maximum size for our vector
     if (_size == _capacity) {
-        grow(calc_grow_size());
+        grow(calc_grow_size(_size + 1));
     }
 
     // Now the index _size is guaranteed to be valid
@@ -374,11 +478,11 @@ void vector<T, Allocator>::push_back(T const& value) {
     _size += 1;
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::push_back(T&& value) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::push_back(T&& value) {
     // If we have reached the maximum size for our vector
     if (_size == _capacity) {
-        grow(calc_grow_size());
+        grow(calc_grow_size(_size + 1));
     }
 
     // Now the index _size is guaranteed to be valid
@@ -386,12 +490,12 @@ void vector<T, Allocator>::push_back(T&& value) {
     _size += 1;
 }
 
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, typename GrowthPolicy>
 template<typename... Args>
-T& vector<T, Allocator>::emplace_back(Args&&... args) {
+T& vector<T, Allocator, GrowthPolicy>::emplace_back(Args&&... args) {
     if (_size == _capacity) {
         
-        grow(calc_grow_size());
+        grow(calc_grow_size(_size + 1));
     }
 
     new (_data + _size) T { stl::forward<Args>(args) ... };
@@ -400,112 +504,263 @@ T& vector<T, Allocator>::emplace_back(Args&&... args) {
     return back();
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::clear() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::pop_back() {
+    STL_ASSERT(!empty(), "pop_back() called on empty vector");
+    destruct_n(_data + _size - 1, 1);
+    _size -= 1;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::clear() {
     destruct_n(_data, _size);
     _size = 0;
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::shrink_to_fit() {
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::shrink_to_fit() {
     if (_size == _capacity) { return; }
     
     grow(_size);
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert(iterator pos, T const& value) {
-    // Avoid code duplication like a boss
-    T cpy = value;
-    return insert(stl::move(cpy));
-}
-
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::insert(iterator pos, T&& value) {
-    if (pos == end()) { 
-        emplace_back(stl::move(value)); 
-        return end() - 1; 
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::swap(vector& other) {
+    if constexpr (!allocator_traits<Allocator>::buffer_survives_move) {
+        vector tmp = stl::move(other);
+        other = stl::move(*this);
+        *this = stl::move(tmp);
+        return;
     }
 
-    T* ptr = _data;
-
-    if (_size + 1 > _capacity) {
-        ptr = allocate(calc_grow_size());
+    if constexpr (allocator_traits<Allocator>::propagate_on_swap) {
+        stl::swap(_allocator, other._allocator);
+    } else {
+        STL_ASSERT(allocator_traits<Allocator>::equal(_allocator, other._allocator), 
+            "cannot swap vectors with unequal allocators");
     }
 
-    stl::size_t const index = pos - _data;
+    stl::swap(_data, other._data);
+    stl::swap(_size, other._size);
+    stl::swap(_capacity, other._capacity);
+}
 
-    // Shift all elements starting at requested index by one. We do this in reverse order to avoid
-    // overwriting values that still have to be moved if no reallocation occurs
-    for (stl::size_t i = _size; i > index; --i) {
-        ptr[i] = stl::move(_data[i - 1]);
-    }
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::insert(iterator pos, T const& value) {
+    // Avoid code duplication like a boss. Copying first also keeps value valid if it lives in this vector
+    T cpy = value;
+    return insert(pos, stl::move(cpy));
+}
 
-    // Insert the value at requested index
-    ptr[index] = stl::move(value);
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::insert(iterator pos, T&& value) {
+    STL_ASSERT(pos >= begin() && pos <= end(), "invalid iterator given to vector::insert()");
 
-    // If we had a reallocation, swap the pointers and also move data from before the index
-    if (_data != ptr) {
-        inplace_move_from_range(ptr, _data, _data + index);
+    stl::size_t const index = pos - _data;
+
+    if (_size == _capacity) {
+        // Construct the new value in the new buffer first, then relocate the elements around it.
+        // Every element is moved exactly once.
+        stl::size_t const new_capacity = calc_grow_size(_size + 1);
+        T* new_data = allocate(new_capacity);
+        new (new_data + index) T { stl::move(value) };
+        relocate_n(new_data, _data, index);
+        relocate_n(new_data + index + 1, _data + index, _size - index);
 
         deallocate(_data, _capacity);
-        _data = ptr;
+        _data = new_data;
+        _capacity = new_capacity;
+    } else {
+        // Shift the tail back by one to open up a slot at index
+        relocate_overlapping_n(_data + index + 1, _data + index, _size - index);
+        new (_data + index) T { stl::move(value) };
     }
     
     _size += 1;
     return begin() + index;
 }
 
-template<typename T, typename Allocator>
-typename vector<T, Allocator>::iterator vector<T, Allocator>::erase(iterator pos) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::insert(iterator pos, stl::size_t n, T const& value) {
+    STL_ASSERT(pos >= begin() && pos <= end(), "invalid iterator given to vector::insert()");
+
+    // Copy first, value may live in this vector and be moved when the gap is opened
+    T cpy = value;
+    T* gap = open_gap(pos - _data, n);
+    inplace_construct_n(gap, n, cpy);
+    _size += n;
+
+    return gap;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<typename InputIt, std::enable_if_t<!std::is_integral_v<InputIt>, int>>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::insert(iterator pos, InputIt first, InputIt last) {
+    STL_ASSERT(pos >= begin() && pos <= end(), "invalid iterator given to vector::insert()");
+
+    stl::size_t const n = stl::abs_distance(first, last);
+    T* gap = open_gap(pos - _data, n);
+    inplace_construct_from_range(gap, first, last);
+    _size += n;
+
+    return gap;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<typename InputIt>
+void vector<T, Allocator, GrowthPolicy>::append(InputIt first, InputIt last) {
+    insert(end(), first, last);
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::erase(iterator pos) {
     STL_ASSERT(pos >= begin() && pos < end(), "invalid iterator given to vector::erase()");
 
     // Destruct the value at pos
     destruct_n(pos, 1);
 
-    // Move all values behind it back by one
-    for (iterator it = pos; it < end() - 1; ++it) {
-        *it = stl::move(*(it + 1));
-    }
+    // Move all values behind it back by one, into the slot that was just vacated
+    relocate_overlapping_n(pos, pos + 1, end() - pos - 1);
     
     _size -= 1;
 
     return pos;
 }
 
-template<typename T, typename Allocator>
-T* vector<T, Allocator>::allocate(stl::size_t n)  {
-    return static_cast<T*>(_allocator.allocate(n * sizeof(T)));
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::erase(iterator first, iterator last) {
+    STL_ASSERT(first >= begin() && first <= last && last <= end(), "invalid range given to vector::erase()");
+
+    stl::size_t const n = last - first;
+    destruct_n(first, n);
+    // Close the gap by moving the tail once
+    relocate_overlapping_n(first, last, end() - last);
+    _size -= n;
+
+    return first;
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::deallocate(T* ptr, stl::size_t n) {
-    _allocator.deallocate(ptr, n * sizeof(T));
+template<typename T, typename Allocator, typename GrowthPolicy>
+typename vector<T, Allocator, GrowthPolicy>::iterator vector<T, Allocator, GrowthPolicy>::unordered_erase(iterator pos) {
+    STL_ASSERT(pos >= begin() && pos < end(), "invalid iterator given to vector::unordered_erase()");
+
+    destruct_n(pos, 1);
+    T* last = end() - 1;
+    if (pos != last) {
+        relocate_n(pos, last, 1);
+    }
+    _size -= 1;
+
+    return pos;
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+template<typename Pred>
+stl::size_t vector<T, Allocator, GrowthPolicy>::erase_if(Pred pred) {
+    stl::size_t out = 0;
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        // Every value is written to the output slot, which only advances when the value is kept.
+        // There is no branch on the predicate, so this does not suffer from mispredictions on random data.
+        // The copy is bytewise since trivially copyable types may still have deleted assignment operators.
+        for (stl::size_t i = 0; i < _size; ++i) {
+            bool const erase = pred(static_cast<T const&>(_data[i]));
+            std::memmove(static_cast<void*>(_data + out), static_cast<void const*>(_data + i), sizeof(T));
+            out += !erase;
+        }
+    } else {
+        for (stl::size_t i = 0; i < _size; ++i) {
+            if (pred(static_cast<T const&>(_data[i]))) {
+                destruct_n(_data + i, 1);
+            } else {
+                // Everything in [out, i) has already been destroyed or moved out of
+                if (out != i) {
+                    relocate_n(_data + out, _data + i, 1);
+                }
+                ++out;
+            }
+        }
+    }
+
+    stl::size_t const erased = _size - out;
+    _size = out;
+    return erased;
 }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::reserve_uninitialized(stl::size_t n) {
+template<typename T, typename Allocator, typename GrowthPolicy>
+T* vector<T, Allocator, GrowthPolicy>::allocate(stl::size_t n)  {
+    return static_cast<T*>(_allocator.allocate_aligned(n * sizeof(T), alignof(T)));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::deallocate(T* ptr, stl::size_t n) {
+    _allocator.deallocate_aligned(ptr, n * sizeof(T), alignof(T));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::reserve_uninitialized(stl::size_t n) {
     _data = allocate(n);
     _capacity = n;
 }
 
-template<typename T, typename Allocator>
-stl::size_t vector<T, Allocator>::calc_grow_size() const {
-    return stl::max((stl::size_t)1, static_cast<stl::size_t>(_capacity * 2));
-}
+template<typename T, typename Allocator, typename GrowthPolicy>
+stl::size_t vector<T, Allocator, GrowthPolicy>::calc_grow_size(stl::size_t required) const {
+    return stl::max(required, GrowthPolicy::next_capacity(_capacity, required, sizeof(T), _allocator));
+}
+
+template<typename T, typename Allocator, typename GrowthPolicy>
+void vector<T, Allocator, GrowthPolicy>::grow(stl::size_t n) {
+    if (_data && n > 0) {
+        // If the allocator can resize the block in place, no elements have to be touched
+        if (n > _capacity && _allocator.try_expand(_data, _capacity * sizeof(T), n * sizeof(T))) {
+            _capacity = n;
+            return;
+        }
+
+        // Trivially relocatable elements can be moved bytewise, so let the allocator move the whole block.
+        // It may be able to do this without copying at all. reallocate() copies as much of the old block as
+        // fits in the new one, so it is only used when that is exactly the live elements (a full vector growing,
+        // or shrink_to_fit()). Otherwise only the live elements are relocated below.
+        if constexpr (is_trivially_relocatable_v<T> && alignof(T) <= default_alignment) {
+            if (stl::min(_capacity, n) == _size) {
+                _data = static_cast<T*>(_allocator.reallocate(_data, _capacity * sizeof(T), n * sizeof(T)));
+                _capacity = n;
+                return;
+            }
+        }
+    }
 
-template<typename T, typename Allocator>
-void vector<T, Allocator>::grow(stl::size_t n) {
-    // Allocate new array and move elements
+    // Allocate new array and relocate elements. This is a single memcpy for trivially relocatable types
     T* new_data = allocate(n);
-    inplace_move_from_range(new_data, begin(), end());
-    // Deallocate old data
+    relocate_n(new_data, _data, _size);
+    // Deallocate old data, relocation already destroyed the old elements
     deallocate(_data, _capacity);
     // Swap
     _capacity = n;
     _data = new_data;
 }
 
+template<typename T, typename Allocator, typename GrowthPolicy>
+T* vector<T, Allocator, GrowthPolicy>::open_gap(stl::size_t index, stl::size_t n) {
+    if (n == 0) { return _data + index; }
+
+    if (_size + n > _capacity) {
+        // Relocate straight into the new buffer, leaving the gap open, so no element is moved twice
+        stl::size_t const new_capacity = calc_grow_size(_size + n);
+        T* new_data = allocate(new_capacity);
+        relocate_n(new_data, _data, index);
+        relocate_n(new_data + index + n, _data + index, _size - index);
+
+        deallocate(_data, _capacity);
+        _data = new_data;
+        _capacity = new_capacity;
+    } else {
+        relocate_overlapping_n(_data + index + n, _data + index, _size - index);
+    }
+
+    return _data + index;
+}
+
 } // namespace stl
 
 #endif
\ No newline at end of file
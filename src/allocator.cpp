@@ -1,21 +1,154 @@
 #include <stl/allocator.hpp>
 
+#include <stl/algorithm.hpp>
+#include <stl/heap_profiler.hpp>
+
+#include <cstdlib>
+#include <cstring>
 #include <new>
 
 namespace stl {
 
+void* allocator_base::allocate_aligned(stl::size_t size, stl::size_t alignment) {
+    if (alignment <= default_alignment) {
+        return allocate(size);
+    }
+
+    if (size == 0) {
+        return nullptr;
+    }
+
+    // Over-allocate so there is room to align the pointer and to store the original pointer right before it.
+    // Since allocate() returns memory aligned to default_alignment this always fits in alignment extra bytes.
+    auto const raw = reinterpret_cast<stl::uintptr_t>(allocate(size + alignment));
+    auto const aligned = (raw + sizeof(void*) + alignment - 1) & ~(alignment - 1);
+    reinterpret_cast<void**>(aligned)[-1] = reinterpret_cast<void*>(raw);
+    return reinterpret_cast<void*>(aligned);
+}
+
+void allocator_base::deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) {
+    if (alignment <= default_alignment) {
+        deallocate(ptr, size);
+        return;
+    }
+
+    if (ptr == nullptr || size == 0) { return; }
+
+    deallocate(static_cast<void**>(ptr)[-1], size + alignment);
+}
+
+bool allocator_base::try_expand(void*, stl::size_t, stl::size_t) {
+    return false;
+}
+
+void* allocator_base::reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+    if (ptr == nullptr) {
+        return allocate(new_size);
+    }
+
+    if (try_expand(ptr, old_size, new_size)) {
+        return ptr;
+    }
+
+    void* new_ptr = allocate(new_size);
+    if (new_ptr) {
+        std::memcpy(new_ptr, ptr, stl::min(old_size, new_size));
+    }
+    deallocate(ptr, old_size);
+    return new_ptr;
+}
+
+stl::size_t allocator_base::good_size(stl::size_t size) const {
+    return size;
+}
+
 void* allocator::allocate(size_t size) {
     if (size == 0) {
         return nullptr;
     }
 
-    return ::operator new(size);
+    // malloc instead of operator new, so reallocate() can use realloc
+    void* ptr = std::malloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    if (detail::heap_profiler_running.load(std::memory_order_relaxed)) {
+        detail::heap_profiler_record_allocate(ptr, size);
+    }
+    return ptr;
 }
 
 void allocator::deallocate(void* ptr, size_t size) {
     if (ptr == nullptr || size == 0) { return; }
-    
-    :: operator delete(ptr, size);
+
+    if (detail::heap_profiler_running.load(std::memory_order_relaxed)) {
+        detail::heap_profiler_record_deallocate(ptr);
+    }
+    std::free(ptr);
+}
+
+void* allocator::allocate_aligned(size_t size, size_t alignment) {
+    if (alignment <= default_alignment) {
+        return allocate(size);
+    }
+
+    if (size == 0) {
+        return nullptr;
+    }
+
+    void* ptr = ::operator new(size, std::align_val_t(alignment));
+    if (detail::heap_profiler_running.load(std::memory_order_relaxed)) {
+        detail::heap_profiler_record_allocate(ptr, size);
+    }
+    return ptr;
+}
+
+void allocator::deallocate_aligned(void* ptr, size_t size, size_t alignment) {
+    if (alignment <= default_alignment) {
+        deallocate(ptr, size);
+        return;
+    }
+
+    if (ptr == nullptr || size == 0) { return; }
+
+    if (detail::heap_profiler_running.load(std::memory_order_relaxed)) {
+        detail::heap_profiler_record_deallocate(ptr);
+    }
+    ::operator delete(ptr, size, std::align_val_t(alignment));
+}
+
+void* allocator::reallocate(void* ptr, size_t old_size, size_t new_size) {
+    if (ptr == nullptr) {
+        return allocate(new_size);
+    }
+
+    if (new_size == 0) {
+        deallocate(ptr, old_size);
+        return nullptr;
+    }
+
+    // realloc extends in place when it can. glibc serves large blocks with mmap and grows those with
+    // mremap, so the pages are remapped instead of copied.
+    bool const profiling = detail::heap_profiler_running.load(std::memory_order_relaxed);
+    if (profiling) {
+        detail::heap_profiler_record_deallocate(ptr);
+    }
+
+    void* new_ptr = std::realloc(ptr, new_size);
+    if (new_ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    if (profiling) {
+        detail::heap_profiler_record_allocate(new_ptr, new_size);
+    }
+    return new_ptr;
+}
+
+allocator_base& default_allocator() {
+    static allocator instance;
+    return instance;
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include <stl/arena_allocator.hpp>
+
+#include <stl/algorithm.hpp>
+
+namespace stl {
+
+struct arena_allocator::block {
+    block* next = nullptr;
+    // Size of the usable data area, excluding the header
+    stl::size_t size = 0;
+};
+
+namespace {
+
+constexpr stl::uintptr_t align_up(stl::uintptr_t value, stl::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Size of the block header, padded so the data that follows it is properly aligned
+template<typename Block>
+constexpr stl::size_t header_size() {
+    return align_up(sizeof(Block), default_alignment);
+}
+
+template<typename Block>
+unsigned char* block_data(Block* b) {
+    return reinterpret_cast<unsigned char*>(b) + header_size<Block>();
+}
+
+}
+
+arena_allocator::arena_allocator() : arena_allocator(default_block_size) {
+
+}
+
+arena_allocator::arena_allocator(stl::size_t block_size, allocator_base* parent) :
+    _block_size(block_size), _parent(parent ? parent : &default_allocator()) {
+
+}
+
+arena_allocator::arena_allocator(arena_allocator&& rhs) :
+    _first(rhs._first), _current(rhs._current), _offset(rhs._offset),
+    _block_size(rhs._block_size), _parent(rhs._parent) {
+    rhs._first = nullptr;
+    rhs._current = nullptr;
+    rhs._offset = 0;
+}
+
+arena_allocator& arena_allocator::operator=(arena_allocator&& rhs) {
+    if (this == &rhs) return *this;
+
+    release();
+
+    _first = rhs._first;
+    _current = rhs._current;
+    _offset = rhs._offset;
+    _block_size = rhs._block_size;
+    _parent = rhs._parent;
+
+    rhs._first = nullptr;
+    rhs._current = nullptr;
+    rhs._offset = 0;
+
+    return *this;
+}
+
+arena_allocator::~arena_allocator() {
+    release();
+}
+
+void* arena_allocator::allocate(stl::size_t size) {
+    return allocate_aligned(size, default_alignment);
+}
+
+void arena_allocator::deallocate(void*, stl::size_t) {
+    // Memory is only reclaimed by reset(), rewind() or release()
+}
+
+void* arena_allocator::allocate_aligned(stl::size_t size, stl::size_t alignment) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    alignment = stl::max(alignment, default_alignment);
+
+    // Block data is only aligned to default_alignment, so align the actual address
+    auto aligned_offset = [this, alignment]() -> stl::size_t {
+        auto const base = reinterpret_cast<stl::uintptr_t>(block_data(_current));
+        return align_up(base + _offset, alignment) - base;
+    };
+
+    stl::size_t offset = _current ? aligned_offset() : 0;
+    if (_current == nullptr || offset + size > _current->size) {
+        // Reserve enough padding to align the start of the new block
+        next_block(size + alignment - default_alignment);
+        offset = aligned_offset();
+    }
+
+    void* ptr = block_data(_current) + offset;
+    _offset = offset + size;
+    return ptr;
+}
+
+void arena_allocator::deallocate_aligned(void*, stl::size_t, stl::size_t) {
+    // Memory is only reclaimed by reset(), rewind() or release()
+}
+
+bool arena_allocator::try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+    if (_current == nullptr || ptr == nullptr) {
+        return false;
+    }
+
+    unsigned char* const data = block_data(_current);
+    unsigned char* const p = static_cast<unsigned char*>(ptr);
+    // Only the last allocation in the current block borders free space
+    if (p < data || p + old_size != data + _offset) {
+        return false;
+    }
+
+    stl::size_t const offset = p - data;
+    if (offset + new_size > _current->size) {
+        return false;
+    }
+
+    _offset = offset + new_size;
+    return true;
+}
+
+arena_allocator::marker arena_allocator::get_marker() const {
+    return marker{ _current, _offset };
+}
+
+void arena_allocator::rewind(marker m) {
+    // Blocks after the marked one stay in the chain and are reused by next_block()
+    _current = static_cast<block*>(m.block);
+    _offset = m.offset;
+}
+
+void arena_allocator::reset() {
+    _current = _first;
+    _offset = 0;
+}
+
+void arena_allocator::release() {
+    block* b = _first;
+    while (b) {
+        block* next = b->next;
+        _parent->deallocate(b, header_size<block>() + b->size);
+        b = next;
+    }
+
+    _first = nullptr;
+    _current = nullptr;
+    _offset = 0;
+}
+
+stl::size_t arena_allocator::block_size() const {
+    return _block_size;
+}
+
+allocator_base* arena_allocator::parent() const {
+    return _parent;
+}
+
+void arena_allocator::next_block(stl::size_t size) {
+    // A null _current with existing blocks means we were rewound to the very start
+    block* candidate = _current ? _current->next : _first;
+    if (candidate && candidate->size >= size) {
+        _current = candidate;
+        _offset = 0;
+        return;
+    }
+
+    // No reusable block is large enough, so insert a new one after the current block.
+    // Oversized requests get a block of their own.
+    stl::size_t const data_size = stl::max(_block_size, size);
+    block* b = static_cast<block*>(_parent->allocate(header_size<block>() + data_size));
+    b->next = candidate;
+    b->size = data_size;
+
+    if (_current) {
+        _current->next = b;
+    } else {
+        _first = b;
+    }
+
+    _current = b;
+    _offset = 0;
+}
+
+}
@@ -0,0 +1,257 @@
+#include <stl/heap_profiler.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GLIBC__)
+    #include <execinfo.h>
+    #define STL_HAS_BACKTRACE 1
+#else
+    #define STL_HAS_BACKTRACE 0
+#endif
+
+namespace stl {
+
+namespace detail {
+
+std::atomic<bool> heap_profiler_running { false };
+
+}
+
+namespace {
+
+constexpr int max_stack_depth = 32;
+// Frames inside the profiler and stl::allocator that are not interesting to report
+constexpr int skipped_frames = 2;
+
+struct sample {
+    stl::size_t size = 0;
+    int depth = 0;
+    void* stack[max_stack_depth];
+};
+
+// The profiler's own bookkeeping uses the global heap, not stl::allocator, so it is never sampled itself
+class sample_table {
+public:
+    void insert(void* ptr, sample const& s) {
+        std::lock_guard<std::mutex> lock(mutex);
+        samples[ptr] = s;
+        live.store(samples.size(), std::memory_order_relaxed);
+    }
+
+    void erase(void* ptr) {
+        // Most frees are not sampled, skip the lock entirely when nothing is
+        if (live.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        samples.erase(ptr);
+        live.store(samples.size(), std::memory_order_relaxed);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        samples.clear();
+        live.store(0, std::memory_order_relaxed);
+    }
+
+    // Live samples grouped by call stack
+    struct stack_totals {
+        stl::size_t count = 0;
+        stl::size_t bytes = 0;
+    };
+
+    std::map<std::vector<void*>, stack_totals> group_by_stack() {
+        std::map<std::vector<void*>, stack_totals> result;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto const& entry : samples) {
+            sample const& s = entry.second;
+            stack_totals& totals = result[std::vector<void*>(s.stack, s.stack + s.depth)];
+            totals.count += 1;
+            totals.bytes += s.size;
+        }
+        return result;
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<void*, sample> samples;
+    std::atomic<stl::size_t> live { 0 };
+};
+
+// Never destroyed, allocations may still be freed during static destruction
+sample_table& get_samples() {
+    static sample_table* instance = new sample_table;
+    return *instance;
+}
+
+std::atomic<stl::size_t> sample_interval { heap_profiler::default_sample_interval };
+
+// Decides which allocations to sample. Distances between samples are drawn from an exponential distribution,
+// which makes sampling unbiased with respect to allocation size and is what pprof assumes when scaling
+// samples back up.
+class sampler {
+public:
+    bool should_sample(stl::size_t size) {
+        if (!initialized) {
+            state = reinterpret_cast<stl::uintptr_t>(this) | 1;
+            bytes_until_sample = next_distance();
+            initialized = true;
+        }
+
+        bytes_until_sample -= static_cast<stl::int64_t>(size);
+        if (bytes_until_sample > 0) {
+            return false;
+        }
+
+        bytes_until_sample = next_distance();
+        return true;
+    }
+
+private:
+    bool initialized = false;
+    stl::int64_t bytes_until_sample = 0;
+    stl::uint64_t state = 0;
+
+    stl::int64_t next_distance() {
+        // xorshift64, good enough for picking sample points
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        // Uniform in (0, 1]
+        double const u = (static_cast<double>(state >> 11) + 1.0) / 9007199254740992.0;
+        double const mean = static_cast<double>(sample_interval.load(std::memory_order_relaxed));
+        return static_cast<stl::int64_t>(-std::log(u) * mean) + 1;
+    }
+};
+
+thread_local sampler thread_sampler;
+
+void write_mapped_libraries(std::FILE* out) {
+    std::fprintf(out, "\nMAPPED_LIBRARIES:\n");
+#if defined(__linux__)
+    // pprof needs the memory map to find the binaries the addresses belong to
+    if (std::FILE* maps = std::fopen("/proc/self/maps", "r")) {
+        char buffer[4096];
+        stl::size_t read = 0;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), maps)) > 0) {
+            std::fwrite(buffer, 1, read, out);
+        }
+        std::fclose(maps);
+    }
+#endif
+}
+
+}
+
+namespace detail {
+
+void heap_profiler_record_allocate(void* ptr, stl::size_t size) {
+    if (ptr == nullptr || !thread_sampler.should_sample(size)) {
+        return;
+    }
+
+    sample s;
+    s.size = size;
+#if STL_HAS_BACKTRACE
+    void* frames[max_stack_depth + skipped_frames];
+    int const depth = backtrace(frames, max_stack_depth + skipped_frames);
+    for (int i = skipped_frames; i < depth; ++i) {
+        s.stack[s.depth++] = frames[i];
+    }
+#endif
+    get_samples().insert(ptr, s);
+}
+
+void heap_profiler_record_deallocate(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    get_samples().erase(ptr);
+}
+
+} // namespace detail
+
+namespace heap_profiler {
+
+void start(stl::size_t interval) {
+    get_samples().clear();
+    sample_interval.store(interval > 0 ? interval : 1, std::memory_order_relaxed);
+    detail::heap_profiler_running.store(true, std::memory_order_release);
+}
+
+void stop() {
+    detail::heap_profiler_running.store(false, std::memory_order_release);
+    get_samples().clear();
+}
+
+bool is_running() {
+    return detail::heap_profiler_running.load(std::memory_order_acquire);
+}
+
+void dump(std::FILE* out) {
+    auto const stacks = get_samples().group_by_stack();
+
+    stl::size_t total_count = 0;
+    stl::size_t total_bytes = 0;
+    for (auto const& entry : stacks) {
+        total_count += entry.second.count;
+        total_bytes += entry.second.bytes;
+    }
+
+    // Only live allocations are tracked, so in-use and allocated totals are the same
+    std::fprintf(out, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n", total_count, total_bytes,
+        total_count, total_bytes, sample_interval.load(std::memory_order_relaxed));
+    for (auto const& entry : stacks) {
+        std::fprintf(out, "%zu: %zu [%zu: %zu] @", entry.second.count, entry.second.bytes,
+            entry.second.count, entry.second.bytes);
+        for (void* frame : entry.first) {
+            std::fprintf(out, " %p", frame);
+        }
+        std::fprintf(out, "\n");
+    }
+
+    write_mapped_libraries(out);
+    std::fflush(out);
+}
+
+void dump_symbolized(std::FILE* out) {
+    auto const stacks = get_samples().group_by_stack();
+
+    // Biggest call stacks first
+    std::multimap<stl::size_t, std::vector<void*> const*, std::greater<stl::size_t>> by_size;
+    for (auto const& entry : stacks) {
+        by_size.emplace(entry.second.bytes, &entry.first);
+    }
+
+    std::fprintf(out, "Live sampled allocations (sample interval %zu bytes)\n",
+        sample_interval.load(std::memory_order_relaxed));
+    for (auto const& entry : by_size) {
+        std::vector<void*> const& stack = *entry.second;
+        std::fprintf(out, "\n%zu bytes in %zu samples\n", entry.first, stacks.at(stack).count);
+#if STL_HAS_BACKTRACE
+        char** symbols = backtrace_symbols(stack.data(), static_cast<int>(stack.size()));
+        for (stl::size_t i = 0; i < stack.size(); ++i) {
+            std::fprintf(out, "    %s\n", symbols ? symbols[i] : "?");
+        }
+        std::free(symbols);
+#else
+        for (void* frame : stack) {
+            std::fprintf(out, "    %p\n", frame);
+        }
+#endif
+    }
+
+    std::fflush(out);
+}
+
+} // namespace heap_profiler
+
+}
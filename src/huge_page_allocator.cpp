@@ -0,0 +1,293 @@
+#include <stl/huge_page_allocator.hpp>
+
+#include <mutex>
+#include <new>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+    #define STL_HAS_MMAP 1
+#else
+    #define STL_HAS_MMAP 0
+#endif
+
+namespace stl {
+
+namespace {
+
+#if STL_HAS_MMAP
+
+constexpr stl::size_t huge_page_size = huge_page_allocator::huge_page_size;
+
+constexpr stl::size_t align_up(stl::size_t value, stl::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+stl::size_t mapped_size(stl::size_t size) {
+    return align_up(size, huge_page_size);
+}
+
+void advise_huge_pages(void* ptr, stl::size_t size) {
+#if defined(MADV_HUGEPAGE)
+    // Only a hint, failure just means we get regular pages
+    madvise(ptr, size, MADV_HUGEPAGE);
+#else
+    (void)ptr;
+    (void)size;
+#endif
+}
+
+// Maps size bytes aligned to huge_page_size with the given protection. size must be a multiple of
+// huge_page_size.
+void* map_aligned(stl::size_t size, int protection, int flags) {
+    // mmap only guarantees regular page alignment, so map an extra huge page and trim the excess
+    stl::size_t const padded = size + huge_page_size;
+    void* raw = mmap(nullptr, padded, protection, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    auto const begin = reinterpret_cast<stl::uintptr_t>(raw);
+    auto const aligned = align_up(begin, huge_page_size);
+    if (aligned != begin) {
+        munmap(raw, aligned - begin);
+    }
+    stl::size_t const tail = begin + padded - (aligned + size);
+    if (tail != 0) {
+        munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+
+    return reinterpret_cast<void*>(aligned);
+}
+
+void* map_pages(stl::size_t size) {
+    void* ptr = map_aligned(size, PROT_READ | PROT_WRITE, 0);
+    advise_huge_pages(ptr, size);
+    return ptr;
+}
+
+// Resizes a mapping while keeping it aligned to huge_page_size. Shrinking and growing in place keep the
+// address. Otherwise the pages are moved into a freshly reserved aligned range, since a plain
+// MREMAP_MAYMOVE may pick any page aligned address.
+void* remap_pages(void* ptr, stl::size_t old_length, stl::size_t new_length) {
+    void* new_ptr = mremap(ptr, old_length, new_length, 0);
+    if (new_ptr != MAP_FAILED) {
+        if (new_length > old_length) {
+            advise_huge_pages(static_cast<unsigned char*>(ptr) + old_length, new_length - old_length);
+        }
+        return ptr;
+    }
+
+    // MREMAP_FIXED replaces the reservation, which never had any pages backing it
+    void* target = map_aligned(new_length, PROT_NONE, MAP_NORESERVE);
+    new_ptr = mremap(ptr, old_length, new_length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (new_ptr == MAP_FAILED) {
+        munmap(target, new_length);
+        throw std::bad_alloc();
+    }
+
+    advise_huge_pages(new_ptr, new_length);
+    return new_ptr;
+}
+
+// Freed mappings are kept here with their pages released, so a vector that is repeatedly
+// rebuilt at the same size does not go through mmap/munmap every time.
+class mapping_cache {
+public:
+    static constexpr stl::size_t max_entries = 4;
+
+    // Returns a cached mapping of exactly size bytes, or null if there is none
+    void* take(stl::size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (stl::size_t i = 0; i < count; ++i) {
+            if (entries[i].size == size) {
+                void* ptr = entries[i].ptr;
+                entries[i] = entries[--count];
+                return ptr;
+            }
+        }
+        return nullptr;
+    }
+
+    // Takes ownership of the mapping if there is room. Returns false otherwise
+    bool put(void* ptr, stl::size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == max_entries) {
+            return false;
+        }
+
+        entries[count++] = entry{ ptr, size };
+        return true;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (stl::size_t i = 0; i < count; ++i) {
+            munmap(entries[i].ptr, entries[i].size);
+        }
+        count = 0;
+    }
+
+private:
+    struct entry {
+        void* ptr;
+        stl::size_t size;
+    };
+
+    std::mutex mutex;
+    entry entries[max_entries];
+    stl::size_t count = 0;
+};
+
+// Never destroyed, mappings may still be freed during static destruction
+mapping_cache& get_cache() {
+    static mapping_cache* instance = new mapping_cache;
+    return *instance;
+}
+
+void* map(stl::size_t size) {
+    stl::size_t const length = mapped_size(size);
+    if (void* ptr = get_cache().take(length)) {
+        return ptr;
+    }
+    return map_pages(length);
+}
+
+void unmap(void* ptr, stl::size_t size) {
+    stl::size_t const length = mapped_size(size);
+    // Give the physical pages back right away, but keep the address range around for reuse
+    madvise(ptr, length, MADV_DONTNEED);
+    if (!get_cache().put(ptr, length)) {
+        munmap(ptr, length);
+    }
+}
+
+#endif
+
+}
+
+huge_page_allocator::huge_page_allocator(stl::size_t threshold) : _threshold(threshold) {
+
+}
+
+void* huge_page_allocator::allocate(stl::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+#if STL_HAS_MMAP
+    if (is_mapped(size)) {
+        return map(size);
+    }
+#endif
+
+    return _fallback.allocate(size);
+}
+
+void huge_page_allocator::deallocate(void* ptr, stl::size_t size) {
+    if (ptr == nullptr || size == 0) { return; }
+
+#if STL_HAS_MMAP
+    if (is_mapped(size)) {
+        unmap(ptr, size);
+        return;
+    }
+#endif
+
+    _fallback.deallocate(ptr, size);
+}
+
+void* huge_page_allocator::allocate_aligned(stl::size_t size, stl::size_t alignment) {
+    // Mappings are aligned to a huge page, which covers any sensible alignment
+    if (is_mapped(size) && alignment <= huge_page_size) {
+        return allocate(size);
+    }
+
+    return _fallback.allocate_aligned(size, alignment);
+}
+
+void huge_page_allocator::deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) {
+    if (is_mapped(size) && alignment <= huge_page_size) {
+        deallocate(ptr, size);
+        return;
+    }
+
+    _fallback.deallocate_aligned(ptr, size, alignment);
+}
+
+bool huge_page_allocator::try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+#if STL_HAS_MMAP
+    if (ptr == nullptr || !is_mapped(old_size) || !is_mapped(new_size)) {
+        return false;
+    }
+
+    stl::size_t const old_length = mapped_size(old_size);
+    stl::size_t const new_length = mapped_size(new_size);
+    if (old_length == new_length) {
+        return true;
+    }
+
+    // Without MREMAP_MAYMOVE this only succeeds if the mapping can be resized where it is
+    if (mremap(ptr, old_length, new_length, 0) == MAP_FAILED) {
+        return false;
+    }
+
+    if (new_length > old_length) {
+        advise_huge_pages(static_cast<unsigned char*>(ptr) + old_length, new_length - old_length);
+    }
+    return true;
+#else
+    (void)ptr;
+    (void)old_size;
+    (void)new_size;
+    return false;
+#endif
+}
+
+void* huge_page_allocator::reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+#if STL_HAS_MMAP
+    if (ptr != nullptr && is_mapped(old_size) && is_mapped(new_size)) {
+        stl::size_t const old_length = mapped_size(old_size);
+        stl::size_t const new_length = mapped_size(new_size);
+        if (old_length == new_length) {
+            return ptr;
+        }
+
+        // The kernel moves the page table entries, no data is copied
+        return remap_pages(ptr, old_length, new_length);
+    }
+
+    if (ptr != nullptr && !is_mapped(old_size) && !is_mapped(new_size)) {
+        return _fallback.reallocate(ptr, old_size, new_size);
+    }
+
+    // Moving between the mapped and the fallback path
+    return allocator_base::reallocate(ptr, old_size, new_size);
+#else
+    return _fallback.reallocate(ptr, old_size, new_size);
+#endif
+}
+
+stl::size_t huge_page_allocator::good_size(stl::size_t size) const {
+#if STL_HAS_MMAP
+    if (is_mapped(size)) {
+        return mapped_size(size);
+    }
+#endif
+    return _fallback.good_size(size);
+}
+
+stl::size_t huge_page_allocator::threshold() const {
+    return _threshold;
+}
+
+void huge_page_allocator::release_cached_memory() {
+#if STL_HAS_MMAP
+    get_cache().clear();
+#endif
+}
+
+bool huge_page_allocator::is_mapped(stl::size_t size) const {
+    return STL_HAS_MMAP && size >= _threshold;
+}
+
+}
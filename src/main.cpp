@@ -0,0 +1,295 @@
+// Benchmarks for the allocators and containers, built with -DBUILD_TEST_APP=ON.
+// Run without arguments to run all of them, or pass the names of the ones to run.
+
+#include <stl/vector.hpp>
+#include <stl/allocator.hpp>
+#include <stl/algorithm.hpp>
+#include <stl/pool_allocator.hpp>
+#include <stl/owner_pool_allocator.hpp>
+#include <stl/growth_policy.hpp>
+#include <stl/concurrent_vector.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+double seconds_since(bench_clock::time_point start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+stl::size_t thread_count() {
+    stl::size_t const n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// Single producer, single consumer ring of vectors. Slots are handed over with acquire/release on the
+// indices only, so the allocator is the only shared state that can contend.
+template<typename Vector>
+class handoff_ring {
+public:
+    static constexpr stl::size_t capacity = 256;
+
+    void push(Vector&& value) {
+        stl::size_t const tail = _tail.load(std::memory_order_relaxed);
+        while (tail - _head.load(std::memory_order_acquire) == capacity) {
+            std::this_thread::yield();
+        }
+        _slots[tail % capacity] = stl::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+    }
+
+    Vector pop() {
+        stl::size_t const head = _head.load(std::memory_order_relaxed);
+        while (_tail.load(std::memory_order_acquire) == head) {
+            std::this_thread::yield();
+        }
+        Vector value = stl::move(_slots[head % capacity]);
+        _head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+private:
+    Vector _slots[capacity];
+    alignas(64) std::atomic<stl::size_t> _head { 0 };
+    alignas(64) std::atomic<stl::size_t> _tail { 0 };
+};
+
+// Producers fill vectors of 1 to 1024 ints and hand them to a consumer thread that destroys them, so
+// every buffer is freed by a thread that did not allocate it.
+template<typename Allocator>
+double producer_consumer(stl::size_t pairs, stl::size_t buffers_per_pair) {
+    using buffer = stl::vector<int, Allocator>;
+
+    stl::vector<handoff_ring<buffer>*> rings;
+    for (stl::size_t i = 0; i < pairs; ++i) {
+        rings.push_back(new handoff_ring<buffer>);
+    }
+
+    auto const start = bench_clock::now();
+
+    stl::vector<std::thread*> threads;
+    for (stl::size_t i = 0; i < pairs; ++i) {
+        handoff_ring<buffer>* ring = rings[i];
+        threads.push_back(new std::thread([ring, buffers_per_pair, i] {
+            stl::size_t seed = i * 7919 + 1;
+            for (stl::size_t n = 0; n < buffers_per_pair; ++n) {
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                stl::size_t const count = 1 + (seed >> 33) % 1024;
+                buffer values;
+                values.reserve(count);
+                for (stl::size_t k = 0; k < count; k += 64) {
+                    values.push_back(int(k));
+                }
+                ring->push(stl::move(values));
+            }
+        }));
+        threads.push_back(new std::thread([ring, buffers_per_pair] {
+            for (stl::size_t n = 0; n < buffers_per_pair; ++n) {
+                buffer values = ring->pop();
+            }
+        }));
+    }
+
+    for (std::thread* thread : threads) {
+        thread->join();
+        delete thread;
+    }
+
+    double const elapsed = seconds_since(start);
+    for (handoff_ring<buffer>* ring : rings) {
+        delete ring;
+    }
+    return elapsed;
+}
+
+void bench_owner_pool() {
+    std::printf("owner_pool: producer/consumer handoff of vector buffers (4 B to 4 KiB)\n");
+    std::printf("%6s %12s %14s %20s\n", "pairs", "allocator", "pool_allocator", "owner_pool_allocator");
+
+    constexpr stl::size_t buffers = 500000;
+    // At least two pairs, so the allocators always see concurrent handoffs
+    stl::size_t const max_pairs = stl::max(thread_count() / 2, stl::size_t(2));
+    for (stl::size_t pairs = 1; pairs <= max_pairs; pairs *= 2) {
+        double const plain = producer_consumer<stl::allocator>(pairs, buffers);
+        double const pool = producer_consumer<stl::pool_allocator>(pairs, buffers);
+        double const owner = producer_consumer<stl::owner_pool_allocator>(pairs, buffers);
+        std::printf("%6zu %11.3fs %13.3fs %19.3fs\n", pairs, plain, pool, owner);
+    }
+    std::printf("\n");
+}
+
+// Forwards to a parent allocator and tracks the bytes the parent really reserves (see good_size()).
+// reallocate() is left to allocator_base, so a moving reallocation briefly holds both buffers, like it
+// does in a real allocator.
+class peak_allocator : public stl::allocator_base {
+public:
+    explicit peak_allocator(stl::allocator_base& parent) : _parent(&parent) {}
+
+    void* allocate(stl::size_t size) override {
+        stl::size_t const reserved = _parent->good_size(size);
+        _live += reserved;
+        _peak = stl::max(_peak, _live);
+        _allocations += 1;
+        return _parent->allocate(size);
+    }
+
+    void deallocate(void* ptr, stl::size_t size) override {
+        if (ptr == nullptr) { return; }
+        _live -= _parent->good_size(size);
+        _parent->deallocate(ptr, size);
+    }
+
+    stl::size_t good_size(stl::size_t size) const override {
+        return _parent->good_size(size);
+    }
+
+    stl::size_t allocations() const { return _allocations; }
+    stl::size_t peak_bytes() const { return _peak; }
+
+private:
+    stl::allocator_base* _parent;
+    stl::size_t _live = 0;
+    stl::size_t _peak = 0;
+    stl::size_t _allocations = 0;
+};
+
+template<typename GrowthPolicy>
+void growth_row(char const* name, stl::allocator_base& parent, stl::size_t vectors, stl::size_t max_elements) {
+    peak_allocator allocator(parent);
+    stl::size_t elements = 0;
+    {
+        stl::vector<stl::vector<int, stl::allocator_ref, GrowthPolicy>> all;
+        all.reserve(vectors);
+        stl::size_t seed = 1;
+        for (stl::size_t i = 0; i < vectors; ++i) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            stl::size_t const count = vectors == 1 ? max_elements : 1 + (seed >> 33) % max_elements;
+            all.emplace_back(stl::allocator_ref(allocator));
+            for (stl::size_t k = 0; k < count; ++k) {
+                all.back().push_back(int(k));
+            }
+            elements += count;
+        }
+    }
+
+    // Every allocation after the first one of a vector is a reallocation
+    std::printf("%-30s %14zu %16zu %10.3f\n", name, allocator.allocations() - vectors, allocator.peak_bytes(),
+        double(allocator.peak_bytes()) / double(elements * sizeof(int)));
+}
+
+void growth_table(char const* title, stl::allocator_base& parent, stl::size_t vectors, stl::size_t max_elements) {
+    std::printf("%s\n", title);
+    std::printf("%-30s %14s %16s %10s\n", "policy", "reallocations", "peak bytes", "peak/used");
+    growth_row<stl::grow_2x>("grow_2x", parent, vectors, max_elements);
+    growth_row<stl::grow_1_5x>("grow_1_5x", parent, vectors, max_elements);
+    // Chunks are scaled to the vectors. Small chunks make large vectors copy quadratically, and chunks
+    // larger than the vectors would only measure the size of one chunk.
+    if (max_elements >= 65536) {
+        growth_row<stl::grow_by_chunk<65536>>("grow_by_chunk<65536>", parent, vectors, max_elements);
+    } else {
+        growth_row<stl::grow_by_chunk<64>>("grow_by_chunk<64>", parent, vectors, max_elements);
+    }
+    growth_row<stl::grow_to_size_class<>>("grow_to_size_class<grow_2x>", parent, vectors, max_elements);
+    growth_row<stl::grow_to_size_class<stl::grow_1_5x>>("grow_to_size_class<grow_1_5x>", parent, vectors, max_elements);
+    growth_row<stl::grow_to_page<>>("grow_to_page<grow_2x>", parent, vectors, max_elements);
+    growth_row<stl::grow_to_page<stl::grow_1_5x>>("grow_to_page<grow_1_5x>", parent, vectors, max_elements);
+    std::printf("\n");
+}
+
+// Peak reserved bytes against reallocations for every growth policy, by pushing ints one at a time.
+// peak/used is the peak divided by the bytes of the elements that were pushed.
+void bench_growth() {
+    stl::allocator plain;
+    stl::pool_allocator pool;
+    growth_table("growth: one vector of 10M ints, stl::allocator", plain, 1, 10000000);
+    growth_table("growth: 100k vectors of 1 to 1000 ints, stl::allocator", plain, 100000, 1000);
+    growth_table("growth: 100k vectors of 1 to 1000 ints, pool_allocator", pool, 100000, 1000);
+}
+
+// Runs f(thread_index) on threads threads at once and returns the elapsed time
+template<typename F>
+double run_threads(stl::size_t threads, F&& f) {
+    stl::vector<std::thread*> running;
+    auto const start = bench_clock::now();
+    for (stl::size_t t = 0; t < threads; ++t) {
+        running.push_back(new std::thread([&f, t] { f(t); }));
+    }
+    for (std::thread* thread : running) {
+        thread->join();
+        delete thread;
+    }
+    return seconds_since(start);
+}
+
+// Threads append records to one shared list, either through concurrent_vector or a mutex around
+// stl::vector::push_back. The total amount of records is the same for every thread count.
+void bench_concurrent_vector() {
+    struct record {
+        stl::uint64_t thread;
+        stl::uint64_t value;
+    };
+
+    constexpr stl::size_t total = 8000000;
+    std::printf("concurrent_vector: %zu appends of 16 byte records, split over the threads\n", total);
+    std::printf("%8s %18s %18s\n", "threads", "mutex + vector", "concurrent_vector");
+
+    // Go past the core count too, to show the behaviour when threads get preempted
+    stl::size_t const max_threads = stl::max(thread_count(), stl::size_t(4));
+    for (stl::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        stl::size_t const per_thread = total / threads;
+
+        std::mutex mutex;
+        stl::vector<record> locked;
+        double const locked_time = run_threads(threads, [&](stl::size_t t) {
+            for (stl::size_t i = 0; i < per_thread; ++i) {
+                std::lock_guard<std::mutex> lock(mutex);
+                locked.push_back(record{ t, i });
+            }
+        });
+
+        stl::concurrent_vector<record> concurrent;
+        double const concurrent_time = run_threads(threads, [&](stl::size_t t) {
+            for (stl::size_t i = 0; i < per_thread; ++i) {
+                concurrent.push_back(record{ t, i });
+            }
+        });
+
+        if (locked.size() != per_thread * threads || concurrent.size() != per_thread * threads) {
+            std::printf("lost records\n");
+        }
+        std::printf("%8zu %17.3fs %17.3fs\n", threads, locked_time, concurrent_time);
+    }
+    std::printf("\n");
+}
+
+struct benchmark {
+    char const* name;
+    void (*run)();
+};
+
+benchmark const benchmarks[] = {
+    { "owner_pool", bench_owner_pool },
+    { "growth", bench_growth },
+    { "concurrent_vector", bench_concurrent_vector },
+};
+
+}
+
+int main(int argc, char** argv) {
+    for (benchmark const& bench : benchmarks) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || std::strcmp(argv[i], bench.name) == 0;
+        }
+        if (selected) {
+            bench.run();
+        }
+    }
+}
@@ -0,0 +1,217 @@
+#include <stl/owner_pool_allocator.hpp>
+
+#include <atomic>
+#include <mutex>
+
+namespace stl {
+
+namespace {
+
+// Slabs are aligned to their size, so the slab header of any block is found by masking its address
+constexpr stl::size_t slab_size = 64 * 1024;
+constexpr stl::size_t slab_header_size = 64;
+constexpr stl::size_t class_count = detail::pool_size_class_count;
+
+struct heap;
+
+struct free_block {
+    free_block* next;
+};
+
+struct slab {
+    heap* owner;
+    stl::size_t class_index;
+};
+
+static_assert(sizeof(slab) <= slab_header_size, "slab header does not fit");
+
+slab* slab_of(void* ptr) {
+    return reinterpret_cast<slab*>(reinterpret_cast<stl::uintptr_t>(ptr) & ~(slab_size - 1));
+}
+
+struct heap {
+    // Only touched by the owning thread
+    free_block* free_lists[class_count] = {};
+    // Blocks freed by other threads. Pushed by anyone, emptied by the owner
+    std::atomic<free_block*> remote_frees { nullptr };
+    // Link in the list of heaps waiting for a new owner
+    heap* next_abandoned = nullptr;
+
+    void* allocate(stl::size_t index) {
+        if (!free_lists[index]) {
+            reclaim_remote_frees();
+        }
+
+        if (!free_lists[index]) {
+            carve_slab(index);
+        }
+
+        free_block* block = free_lists[index];
+        free_lists[index] = block->next;
+        return block;
+    }
+
+    void deallocate_local(void* ptr, stl::size_t index) {
+        free_block* block = static_cast<free_block*>(ptr);
+        block->next = free_lists[index];
+        free_lists[index] = block;
+    }
+
+    void deallocate_remote(void* ptr) {
+        free_block* block = static_cast<free_block*>(ptr);
+        free_block* head = remote_frees.load(std::memory_order_relaxed);
+        do {
+            block->next = head;
+        } while (!remote_frees.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Moves every block freed by other threads back into the local free lists
+    void reclaim_remote_frees() {
+        // Taking the whole list at once means there is no pop, so there is no ABA problem
+        free_block* block = remote_frees.exchange(nullptr, std::memory_order_acquire);
+        while (block) {
+            free_block* next = block->next;
+            deallocate_local(block, slab_of(block)->class_index);
+            block = next;
+        }
+    }
+
+    void carve_slab(stl::size_t index) {
+        stl::size_t const size = detail::pool_size_class_size(index);
+        unsigned char* memory = static_cast<unsigned char*>(default_allocator().allocate_aligned(slab_size, slab_size));
+
+        slab* header = reinterpret_cast<slab*>(memory);
+        header->owner = this;
+        header->class_index = index;
+
+        // Push in reverse so blocks are handed out in address order
+        stl::size_t const count = (slab_size - slab_header_size) / size;
+        for (stl::size_t i = count; i > 0; --i) {
+            deallocate_local(memory + slab_header_size + (i - 1) * size, index);
+        }
+    }
+};
+
+class heap_registry {
+public:
+    // Returns an abandoned heap if there is one, a new heap otherwise
+    heap* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (abandoned) {
+                heap* h = abandoned;
+                abandoned = h->next_abandoned;
+                h->next_abandoned = nullptr;
+                return h;
+            }
+        }
+        return new heap;
+    }
+
+    // Heaps are never destroyed, since blocks they own may still be in use and freed later
+    void abandon(heap* h) {
+        std::lock_guard<std::mutex> lock(mutex);
+        h->next_abandoned = abandoned;
+        abandoned = h;
+    }
+
+private:
+    std::mutex mutex;
+    heap* abandoned = nullptr;
+};
+
+// Never destroyed, threads may exit during static destruction
+heap_registry& get_registry() {
+    static heap_registry* instance = new heap_registry;
+    return *instance;
+}
+
+thread_local heap* current_heap = nullptr;
+// Set once the heap of this thread was given back. thread_local objects destroyed after that may still
+// allocate, and a heap acquired for them would never be given back. A bool has no destructor and can still
+// be read at that point.
+thread_local bool owner_destroyed = false;
+
+// Gives the heap of a thread to the registry when the thread exits
+struct heap_owner {
+    ~heap_owner() {
+        if (current_heap) {
+            current_heap->reclaim_remote_frees();
+            get_registry().abandon(current_heap);
+            current_heap = nullptr;
+        }
+        owner_destroyed = true;
+    }
+};
+
+thread_local heap_owner owner;
+
+heap* get_heap() {
+    if (!current_heap) {
+        current_heap = get_registry().acquire();
+        // Touching owner registers its destructor, so the heap is given back when this thread exits
+        (void)&owner;
+    }
+    return current_heap;
+}
+
+// Allocates from a heap borrowed from the registry, for threads that already gave their own heap back
+void* allocate_borrowed(stl::size_t index) {
+    heap_registry& registry = get_registry();
+    heap* h = registry.acquire();
+    void* ptr = nullptr;
+    try {
+        ptr = h->allocate(index);
+    } catch (...) {
+        registry.abandon(h);
+        throw;
+    }
+    registry.abandon(h);
+    return ptr;
+}
+
+}
+
+void* owner_pool_allocator::allocate(stl::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    if (size > max_pooled_size) {
+        return default_allocator().allocate(size);
+    }
+
+    if (owner_destroyed) {
+        return allocate_borrowed(detail::pool_size_class(size));
+    }
+
+    return get_heap()->allocate(detail::pool_size_class(size));
+}
+
+void owner_pool_allocator::deallocate(void* ptr, stl::size_t size) {
+    if (ptr == nullptr || size == 0) { return; }
+
+    if (size > max_pooled_size) {
+        default_allocator().deallocate(ptr, size);
+        return;
+    }
+
+    // After the owner of this thread is destroyed current_heap is null, so every block is freed remotely to
+    // the heap that owns it, whichever thread holds that heap now
+    slab* s = slab_of(ptr);
+    if (s->owner == current_heap) {
+        current_heap->deallocate_local(ptr, s->class_index);
+    } else {
+        s->owner->deallocate_remote(ptr);
+    }
+}
+
+stl::size_t owner_pool_allocator::good_size(stl::size_t size) const {
+    if (size == 0 || size > max_pooled_size) {
+        return default_allocator().good_size(size);
+    }
+
+    return detail::pool_size_class_size(detail::pool_size_class(size));
+}
+
+}
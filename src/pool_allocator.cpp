@@ -0,0 +1,303 @@
+#include <stl/pool_allocator.hpp>
+
+#include <stl/algorithm.hpp>
+
+#include <mutex>
+
+namespace stl {
+
+namespace {
+
+// Slabs are carved up into blocks of a single size class
+constexpr stl::size_t slab_size = 64 * 1024;
+
+constexpr stl::size_t small_class_limit = 128;
+constexpr stl::size_t small_class_count = small_class_limit / 16;
+constexpr stl::size_t classes_per_doubling = 4;
+constexpr stl::size_t class_count = detail::pool_size_class_count;
+
+static_assert(class_count == small_class_count + 5 * classes_per_doubling, "128 -> 4096 is 5 doublings");
+
+stl::size_t highest_bit(stl::size_t value) {
+    stl::size_t bit = 0;
+    while (value >>= 1) {
+        ++bit;
+    }
+    return bit;
+}
+
+stl::size_t class_index(stl::size_t size) {
+    return detail::pool_size_class(size);
+}
+
+stl::size_t class_size(stl::size_t index) {
+    return detail::pool_size_class_size(index);
+}
+
+// Amount of blocks moved between a thread cache and the depot at once
+stl::size_t batch_count(stl::size_t index) {
+    return stl::max(stl::size_t(4), stl::min(stl::size_t(64), 16 * 1024 / class_size(index)));
+}
+
+// Free blocks are linked through their first bytes. The first block of a batch stored in the depot
+// also links to the next batch, which is fine since the smallest class holds two pointers.
+struct free_block {
+    free_block* next;
+    free_block* next_batch;
+};
+
+class depot {
+public:
+    // Returns a chain of batch_count(index) blocks
+    free_block* pop_batch(stl::size_t index) {
+        size_class& sc = classes[index];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+
+        if (!sc.batches) {
+            carve_slab(sc, index);
+        }
+
+        free_block* batch = sc.batches;
+        sc.batches = batch->next_batch;
+        return batch;
+    }
+
+    void push_batch(stl::size_t index, free_block* batch) {
+        size_class& sc = classes[index];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+
+        batch->next_batch = sc.batches;
+        sc.batches = batch;
+    }
+
+    // Single blocks, for threads that no longer have a cache. They are collected into a loose list
+    // that becomes a regular batch once it is full.
+    void* pop_block(stl::size_t index) {
+        size_class& sc = classes[index];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+
+        if (!sc.loose) {
+            if (!sc.batches) {
+                carve_slab(sc, index);
+            }
+
+            sc.loose = sc.batches;
+            sc.batches = sc.loose->next_batch;
+            sc.loose_count = batch_count(index);
+        }
+
+        free_block* block = sc.loose;
+        sc.loose = block->next;
+        sc.loose_count -= 1;
+        return block;
+    }
+
+    void push_block(stl::size_t index, void* ptr) {
+        size_class& sc = classes[index];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+
+        free_block* block = static_cast<free_block*>(ptr);
+        block->next = sc.loose;
+        sc.loose = block;
+        sc.loose_count += 1;
+
+        if (sc.loose_count == batch_count(index)) {
+            sc.loose->next_batch = sc.batches;
+            sc.batches = sc.loose;
+            sc.loose = nullptr;
+            sc.loose_count = 0;
+        }
+    }
+
+private:
+    struct size_class {
+        std::mutex mutex;
+        free_block* batches = nullptr;
+        // Always holds less than a full batch
+        free_block* loose = nullptr;
+        stl::size_t loose_count = 0;
+    };
+
+    size_class classes[class_count];
+
+    // Splits a new slab into batches and adds them to the size class
+    void carve_slab(size_class& sc, stl::size_t index) {
+        stl::size_t const size = class_size(index);
+        stl::size_t const per_batch = batch_count(index);
+        stl::size_t const batches = slab_size / size / per_batch;
+
+        unsigned char* slab = static_cast<unsigned char*>(default_allocator().allocate(slab_size));
+        for (stl::size_t b = 0; b < batches; ++b) {
+            unsigned char* first = slab + b * per_batch * size;
+            for (stl::size_t i = 0; i < per_batch; ++i) {
+                free_block* block = reinterpret_cast<free_block*>(first + i * size);
+                block->next = i + 1 < per_batch ? reinterpret_cast<free_block*>(first + (i + 1) * size) : nullptr;
+            }
+
+            free_block* batch = reinterpret_cast<free_block*>(first);
+            batch->next_batch = sc.batches;
+            sc.batches = batch;
+        }
+    }
+};
+
+// The depot is intentionally never destroyed, so blocks freed during static destruction are still valid.
+depot& get_depot() {
+    static depot* instance = new depot;
+    return *instance;
+}
+
+// Set when the thread's cache is destroyed. Thread locals are destroyed before static objects, so
+// containers freed during static destruction would otherwise use a dead cache. A bool has no destructor
+// and can still be read at that point.
+thread_local bool cache_destroyed = false;
+
+class thread_cache {
+public:
+    ~thread_cache() {
+        // Give everything back so other threads can use it. The depot only takes full batches, the
+        // rest is returned one block at a time.
+        for (stl::size_t index = 0; index < class_count; ++index) {
+            while (lists[index].count >= batch_count(index)) {
+                flush_batch(index);
+            }
+
+            while (free_block* block = lists[index].head) {
+                lists[index].head = block->next;
+                get_depot().push_block(index, block);
+            }
+            lists[index].count = 0;
+        }
+
+        cache_destroyed = true;
+    }
+
+    void* allocate(stl::size_t index) {
+        free_list& list = lists[index];
+        if (!list.head) {
+            list.head = get_depot().pop_batch(index);
+            list.count = batch_count(index);
+        }
+
+        free_block* block = list.head;
+        list.head = block->next;
+        list.count -= 1;
+        return block;
+    }
+
+    void deallocate(void* ptr, stl::size_t index) {
+        free_list& list = lists[index];
+        free_block* block = static_cast<free_block*>(ptr);
+        block->next = list.head;
+        list.head = block;
+        list.count += 1;
+
+        // Keep one batch around so alternating allocate/deallocate does not hit the depot every time
+        if (list.count >= 2 * batch_count(index)) {
+            flush_batch(index);
+        }
+    }
+
+private:
+    struct free_list {
+        free_block* head = nullptr;
+        stl::size_t count = 0;
+    };
+
+    free_list lists[class_count];
+
+    // Returns batch_count(index) blocks to the depot. The list must hold at least that many
+    void flush_batch(stl::size_t index) {
+        free_list& list = lists[index];
+        stl::size_t const n = batch_count(index);
+
+        free_block* first = list.head;
+        free_block* last = first;
+        for (stl::size_t i = 1; i < n; ++i) {
+            last = last->next;
+        }
+
+        list.head = last->next;
+        list.count -= n;
+        last->next = nullptr;
+        get_depot().push_batch(index, first);
+    }
+};
+
+thread_local thread_cache cache;
+
+}
+
+namespace detail {
+
+stl::size_t pool_size_class(stl::size_t size) {
+    if (size <= small_class_limit) {
+        return (size + 15) / 16 - 1;
+    }
+
+    // size lies in (2^p, 2^(p + 1)]
+    stl::size_t const p = highest_bit(size - 1);
+    stl::size_t const base = stl::size_t(1) << p;
+    stl::size_t const step = base / classes_per_doubling;
+    stl::size_t const sub_index = (size - base + step - 1) / step - 1;
+    return small_class_count + (p - highest_bit(small_class_limit)) * classes_per_doubling + sub_index;
+}
+
+stl::size_t pool_size_class_size(stl::size_t index) {
+    if (index < small_class_count) {
+        return (index + 1) * 16;
+    }
+
+    stl::size_t const doubling = (index - small_class_count) / classes_per_doubling;
+    stl::size_t const sub_index = (index - small_class_count) % classes_per_doubling;
+    stl::size_t const base = small_class_limit << doubling;
+    return base + (sub_index + 1) * (base / classes_per_doubling);
+}
+
+} // namespace detail
+
+void* pool_allocator::allocate(stl::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    if (size > max_pooled_size) {
+        return default_allocator().allocate(size);
+    }
+
+    if (cache_destroyed) {
+        return get_depot().pop_block(class_index(size));
+    }
+
+    return cache.allocate(class_index(size));
+}
+
+void pool_allocator::deallocate(void* ptr, stl::size_t size) {
+    if (ptr == nullptr || size == 0) { return; }
+
+    if (size > max_pooled_size) {
+        default_allocator().deallocate(ptr, size);
+        return;
+    }
+
+    if (cache_destroyed) {
+        get_depot().push_block(class_index(size), ptr);
+        return;
+    }
+
+    cache.deallocate(ptr, class_index(size));
+}
+
+stl::size_t pool_allocator::good_size(stl::size_t size) const {
+    return block_size(size);
+}
+
+stl::size_t pool_allocator::block_size(stl::size_t size) {
+    if (size == 0 || size > max_pooled_size) {
+        return size;
+    }
+
+    return class_size(class_index(size));
+}
+
+}
@@ -0,0 +1,165 @@
+#include <stl/tracking_allocator.hpp>
+
+namespace stl {
+
+namespace {
+
+stl::size_t histogram_bucket(stl::size_t size) {
+    stl::size_t bucket = 0;
+    while ((size >>= 1) && bucket < allocation_stats::histogram_buckets - 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+std::atomic<allocation_tag*> tag_list { nullptr };
+
+}
+
+void allocation_counters::record_allocate(stl::size_t size) {
+    _allocation_count.fetch_add(1, std::memory_order_relaxed);
+    _total_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    _size_histogram[histogram_bucket(size)].fetch_add(1, std::memory_order_relaxed);
+    add_live_bytes(size);
+}
+
+void allocation_counters::record_deallocate(stl::size_t size) {
+    _deallocation_count.fetch_add(1, std::memory_order_relaxed);
+    _live_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void allocation_counters::record_reallocate(stl::size_t old_size, stl::size_t new_size) {
+    _reallocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (new_size > old_size) {
+        _total_allocated_bytes.fetch_add(new_size - old_size, std::memory_order_relaxed);
+        add_live_bytes(new_size - old_size);
+    } else {
+        _live_bytes.fetch_sub(old_size - new_size, std::memory_order_relaxed);
+    }
+}
+
+void allocation_counters::record_reallocate_result(void const* ptr, stl::size_t old_size, void const* new_ptr, stl::size_t new_size) {
+    if (ptr == nullptr) {
+        if (new_ptr) {
+            record_allocate(new_size);
+        }
+        return;
+    }
+
+    if (new_ptr == nullptr) {
+        record_deallocate(old_size);
+        return;
+    }
+
+    record_reallocate(old_size, new_size);
+}
+
+allocation_stats allocation_counters::snapshot() const {
+    // Counters are read one by one, so a snapshot taken during allocations is not exact
+    allocation_stats stats;
+    stats.live_bytes = _live_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes = _peak_bytes.load(std::memory_order_relaxed);
+    stats.allocation_count = _allocation_count.load(std::memory_order_relaxed);
+    stats.deallocation_count = _deallocation_count.load(std::memory_order_relaxed);
+    stats.reallocation_count = _reallocation_count.load(std::memory_order_relaxed);
+    stats.total_allocated_bytes = _total_allocated_bytes.load(std::memory_order_relaxed);
+    for (stl::size_t i = 0; i < allocation_stats::histogram_buckets; ++i) {
+        stats.size_histogram[i] = _size_histogram[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void allocation_counters::reset() {
+    // Live bytes are kept, since the memory they describe is still allocated
+    _peak_bytes.store(_live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    _allocation_count.store(0, std::memory_order_relaxed);
+    _deallocation_count.store(0, std::memory_order_relaxed);
+    _reallocation_count.store(0, std::memory_order_relaxed);
+    _total_allocated_bytes.store(0, std::memory_order_relaxed);
+    for (auto& bucket : _size_histogram) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void allocation_counters::add_live_bytes(stl::size_t size) {
+    stl::size_t const live = _live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    stl::size_t peak = _peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !_peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        // peak was reloaded by compare_exchange_weak
+    }
+}
+
+tracking_allocator::tracking_allocator() : tracking_allocator(default_allocator()) {
+
+}
+
+tracking_allocator::tracking_allocator(allocator_base& parent) : _parent(&parent) {
+
+}
+
+void* tracking_allocator::allocate(stl::size_t size) {
+    void* ptr = _parent->allocate(size);
+    if (ptr) {
+        _counters.record_allocate(size);
+    }
+    return ptr;
+}
+
+void tracking_allocator::deallocate(void* ptr, stl::size_t size) {
+    if (ptr == nullptr) { return; }
+    _counters.record_deallocate(size);
+    _parent->deallocate(ptr, size);
+}
+
+void* tracking_allocator::allocate_aligned(stl::size_t size, stl::size_t alignment) {
+    void* ptr = _parent->allocate_aligned(size, alignment);
+    if (ptr) {
+        _counters.record_allocate(size);
+    }
+    return ptr;
+}
+
+void tracking_allocator::deallocate_aligned(void* ptr, stl::size_t size, stl::size_t alignment) {
+    if (ptr == nullptr) { return; }
+    _counters.record_deallocate(size);
+    _parent->deallocate_aligned(ptr, size, alignment);
+}
+
+bool tracking_allocator::try_expand(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+    if (!_parent->try_expand(ptr, old_size, new_size)) {
+        return false;
+    }
+    _counters.record_reallocate(old_size, new_size);
+    return true;
+}
+
+void* tracking_allocator::reallocate(void* ptr, stl::size_t old_size, stl::size_t new_size) {
+    void* new_ptr = _parent->reallocate(ptr, old_size, new_size);
+    _counters.record_reallocate_result(ptr, old_size, new_ptr, new_size);
+    return new_ptr;
+}
+
+stl::size_t tracking_allocator::good_size(stl::size_t size) const {
+    return _parent->good_size(size);
+}
+
+allocation_counters& tracking_allocator::counters() {
+    return _counters;
+}
+
+allocation_stats tracking_allocator::snapshot() const {
+    return _counters.snapshot();
+}
+
+allocation_tag::allocation_tag(char const* name) : name(name) {
+    allocation_tag* head = tag_list.load(std::memory_order_relaxed);
+    do {
+        next = head;
+    } while (!tag_list.compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+}
+
+allocation_tag const* allocation_tags() {
+    return tag_list.load(std::memory_order_acquire);
+}
+
+}